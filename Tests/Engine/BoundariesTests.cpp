@@ -7,6 +7,7 @@
 #include "Verify.h"
 
 #include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/io.hpp>
 
 #include <Vortex/Engine/Boundaries.h>
@@ -209,6 +210,39 @@ TEST(BoundariesTests, Intersection)
   CheckLevelSet(data, outTexture);
 }
 
+TEST(BoundariesTests, ShapeBatch)
+{
+  glm::ivec2 size(20);
+
+  std::vector<glm::vec2> points = {{0.0f, 0.0f}, {4.0f, 0.0f}, {4.0f, 4.0f}, {0.0f, 4.0f}};
+
+  auto batch = std::make_shared<ShapeBatch>(*device, 4, 8, 20.0f);
+  auto circle = batch->AddCircle(3.0f);
+  auto square1 = batch->AddPolygon(points);
+  auto square2 = batch->AddRectangle({4.0f, 4.0f});
+
+  glm::vec2 circlePos(14.0f, 4.0f), square1Pos(5.0f, 10.0f), square2Pos(12.0f, 12.0f);
+  batch->SetTransform(circle, glm::translate(glm::mat4(1.0f), glm::vec3(circlePos, 0.0f)));
+  batch->SetTransform(square1, glm::translate(glm::mat4(1.0f), glm::vec3(square1Pos, 0.0f)));
+  batch->SetTransform(square2, glm::translate(glm::mat4(1.0f), glm::vec3(square2Pos, 0.0f)));
+
+  std::vector<float> data(size.x * size.y, 100.0f);
+  DrawCircle(size, data, 3.0f, circlePos);
+  DrawSignedSquare(size, points, data, square1Pos);
+  DrawSignedSquare(size, points, data, square2Pos);
+
+  LevelSet levelSet(*device, size);
+  auto clear = std::make_shared<Clear>(glm::vec4{100.0f, 0.0f, 0.0f, 0.0f});
+
+  levelSet.Record({clear, batch}, UnionBlend).Submit();
+  device->WaitIdle();
+
+  Texture outTexture(*device, size.x, size.y, Format::R32Sfloat, MemoryUsage::Cpu);
+  device->Execute([&](CommandEncoder& command) { outTexture.CopyFrom(command, levelSet); });
+
+  CheckLevelSet(data, outTexture);
+}
+
 float clamp(float x, float min, float max)
 {
   if (x < min)
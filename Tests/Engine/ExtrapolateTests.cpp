@@ -77,6 +77,45 @@ TEST(ExtrapolateTest, Extrapolate)
   CheckValid(size, sim, valid);
 }
 
+TEST(ExtrapolateTest, ExtrapolateSaveCopy)
+{
+  glm::ivec2 size(50);
+
+  FluidSim sim;
+  sim.initialize(1.0f, size.x, size.y);
+  sim.set_boundary(complex_boundary_phi);
+
+  AddParticles(size, sim, complex_boundary_phi);
+
+  sim.add_force(0.01f);
+  sim.apply_projection(0.01f);
+
+  Buffer<glm::ivec2> valid(*device, size.x * size.y, MemoryUsage::Cpu);
+  SetValid(size, sim, valid);
+
+  Velocity velocity(*device, size);
+  SetVelocity(*device, size, velocity, sim);
+
+  extrapolate(sim.u, sim.u_valid);
+  extrapolate(sim.v, sim.v_valid);
+
+  Extrapolation extrapolation(*device, size, valid, velocity, 10);
+  extrapolation.ExtrapolateSaveCopy();
+
+  device->WaitIdle();
+
+  CheckVelocity(*device, size, velocity, sim);
+  CheckValid(size, sim, valid);
+
+  Texture output(*device, size.x, size.y, Format::R32G32Sfloat, MemoryUsage::Cpu);
+  device->Execute([&](CommandEncoder& command) { output.CopyFrom(command, velocity); });
+
+  std::vector<glm::vec2> velocityData(size.x * size.y);
+  output.CopyTo(velocityData);
+
+  CheckVelocity(*device, size, velocity.D(), velocityData);
+}
+
 TEST(ExtrapolateTest, Constrain)
 {
   // FIXME increase size
@@ -52,6 +52,94 @@ void CheckDifference(Texture& texture,
   }
 }
 
+namespace
+{
+float RedistanceG(float s, float w, float wxp, float wxn, float wyp, float wyn)
+{
+  float a = w - wxn;
+  float b = wxp - w;
+  float c = w - wyn;
+  float d = wyp - w;
+
+  if (s > 0.0f)
+  {
+    float ap = std::max(a, 0.0f);
+    float bn = std::min(b, 0.0f);
+    float cp = std::max(c, 0.0f);
+    float dn = std::min(d, 0.0f);
+
+    return std::sqrt(std::max(ap * ap, bn * bn) + std::max(cp * cp, dn * dn)) - 1.0f;
+  }
+  else
+  {
+    float an = std::min(a, 0.0f);
+    float bp = std::max(b, 0.0f);
+    float cn = std::min(c, 0.0f);
+    float dp = std::max(d, 0.0f);
+
+    return std::sqrt(std::max(an * an, bp * bp) + std::max(cn * cn, dp * dp)) - 1.0f;
+  }
+}
+
+// host version of Redistance.comp, with neighbours clamped to the edge
+std::vector<float> Redistance(const glm::ivec2& size,
+                              const std::vector<float>& phi0,
+                              int iterations,
+                              float delta)
+{
+  auto get = [&](const std::vector<float>& phi, int i, int j)
+  {
+    i = glm::clamp(i, 0, size.x - 1);
+    j = glm::clamp(j, 0, size.y - 1);
+    return phi[i + j * size.x];
+  };
+
+  std::vector<float> phi = phi0;
+  for (int k = 0; k < iterations; k++)
+  {
+    std::vector<float> phiBack(phi.size());
+    for (int j = 0; j < size.y; j++)
+    {
+      for (int i = 0; i < size.x; i++)
+      {
+        float w0 = get(phi0, i, j);
+        float wxp0 = get(phi0, i + 1, j);
+        float wxn0 = get(phi0, i - 1, j);
+        float wyp0 = get(phi0, i, j + 1);
+        float wyn0 = get(phi0, i, j - 1);
+
+        float w = get(phi, i, j);
+        float s = w0 > 0.0f ? 1.0f : (w0 < 0.0f ? -1.0f : 0.0f);
+
+        if (w0 * wxp0 < 0.0f || w0 * wxn0 < 0.0f || w0 * wyp0 < 0.0f || w0 * wyn0 < 0.0f)
+        {
+          float wx0 = std::max(std::max(std::abs(0.5f * (wxp0 - wxn0)), std::abs(wxp0 - w0)),
+                               std::max(std::abs(w0 - wxn0), 0.001f));
+          float wy0 = std::max(std::max(std::abs(0.5f * (wyp0 - wyn0)), std::abs(wyp0 - w0)),
+                               std::max(std::abs(w0 - wyn0), 0.001f));
+          float d = w0 / std::sqrt(wx0 * wx0 + wy0 * wy0);
+
+          phiBack[i + j * size.x] = w - delta * (s * std::abs(w) - d);
+        }
+        else
+        {
+          float g = RedistanceG(s,
+                                w,
+                                get(phi, i + 1, j),
+                                get(phi, i - 1, j),
+                                get(phi, i, j + 1),
+                                get(phi, i, j - 1));
+          phiBack[i + j * size.x] = w - delta * s * g;
+        }
+      }
+    }
+    phi = phiBack;
+  }
+
+  return phi;
+}
+}  // namespace
+
 TEST(LevelSetTests, SimpleCircle)
 {
   glm::ivec2 size(50);
@@ -151,3 +239,46 @@ TEST(LevelSetTests, Extrapolate)
     EXPECT_FLOAT_EQ(-0.5f, liquidData[20 + (i + 10) * size.x]);
   }
 }
+
+TEST(LevelSetTests, RedistanceTiled)
+{
+  // size is not a multiple of the tiles, and the iterations are done with
+  // one pair of tiled dispatches and a pair of global dispatches
+  glm::ivec2 size(70, 45);
+  const int iterations = 10;
+
+  std::vector<float> data(size.x * size.y);
+  for (int j = 0; j < size.y; j++)
+  {
+    for (int i = 0; i < size.x; i++)
+    {
+      // not a distance field: the gradient is 3 instead of 1
+      glm::vec2 pos(i - 30.0f, j - 20.0f);
+      data[i + j * size.x] = 3.0f * (glm::length(pos) - 12.0f);
+    }
+  }
+
+  LevelSet levelSet(*device, size, iterations);
+  Texture localLevelSet(*device, size.x, size.y, Format::R32Sfloat, MemoryUsage::Cpu);
+  localLevelSet.CopyFrom(data);
+
+  device->Execute([&](CommandEncoder& command) { levelSet.CopyFrom(command, localLevelSet); });
+
+  levelSet.Reinitialise();
+  device->WaitIdle();
+
+  device->Execute([&](CommandEncoder& command) { localLevelSet.CopyFrom(command, levelSet); });
+
+  std::vector<float> output(size.x * size.y);
+  localLevelSet.CopyTo(output);
+
+  auto expected = Redistance(size, data, iterations, 0.1f);
+  for (int j = 0; j < size.y; j++)
+  {
+    for (int i = 0; i < size.x; i++)
+    {
+      int index = i + j * size.x;
+      EXPECT_NEAR(expected[index], output[index], 1e-3f) << "Mismatch at " << i << ", " << j;
+    }
+  }
+}
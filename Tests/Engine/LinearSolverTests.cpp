@@ -14,8 +14,11 @@
 #include "VariationalHelpers.h"
 #include "Verify.h"
 
+#include <glm/gtc/packing.hpp>
+
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <numeric>
 
 using namespace Vortex::Renderer;
@@ -106,6 +109,89 @@ TEST(LinearSolverTests, ReduceMax)
   ASSERT_EQ(150.0f, outputData[0]);
 }
 
+TEST(LinearSolverTests, ReduceDot)
+{
+  glm::ivec2 size(100, 150);
+  int total_size = size.x * size.y;
+
+  Buffer<float> input1(*device, total_size, MemoryUsage::Cpu);
+  Buffer<float> input2(*device, total_size, MemoryUsage::Cpu);
+  Buffer<float> output(*device, 1, MemoryUsage::Cpu);
+
+  ReduceDot reduce(*device, total_size);
+  auto reduceBound = reduce.Bind(input1, input2, output);
+
+  std::vector<float> inputData1(total_size), inputData2(total_size);
+  float dot = 0.0f;
+  for (int i = 0; i < total_size; i++)
+  {
+    inputData1[i] = (i % 5) - 2.0f;
+    inputData2[i] = (i % 3) * 0.5f;
+    dot += inputData1[i] * inputData2[i];
+  }
+
+  CopyFrom(input1, inputData1);
+  CopyFrom(input2, inputData2);
+
+  device->Execute([&](CommandEncoder& command) { reduceBound.Record(command); });
+
+  std::vector<float> outputData(1, 0.0f);
+  CopyTo(output, outputData);
+
+  ASSERT_FLOAT_EQ(dot, outputData[0]);
+
+  ReduceSum reduceSum(*device, total_size);
+  EXPECT_THROW(reduceSum.Bind(input1, input2, output), std::runtime_error);
+}
+
+TEST(LinearSolverTests, ReduceOperation)
+{
+  int size = 2000;
+
+  Buffer<glm::vec2> input(*device, size, MemoryUsage::Cpu);
+  Buffer<glm::vec2> output(*device, 1, MemoryUsage::Cpu);
+
+  ReduceOperation<glm::vec2, ReduceOp::Min> reduceMin(*device, size);
+  ReduceOperation<glm::vec2, ReduceOp::SumSquares> reduceSumSquares(*device, size);
+
+  std::vector<glm::vec2> inputData(size);
+  for (int i = 0; i < size; i++)
+  {
+    inputData[i] = glm::vec2(i % 7 - 3.0f, 0.5f);
+  }
+
+  CopyFrom(input, inputData);
+
+  auto reduceMinBound = reduceMin.Bind(input, output);
+  device->Execute([&](CommandEncoder& command) { reduceMinBound.Record(command); });
+
+  std::vector<glm::vec2> outputData(1);
+  CopyTo(output, outputData);
+
+  EXPECT_EQ(-3.0f, outputData[0].x);
+  EXPECT_EQ(0.5f, outputData[0].y);
+
+  // run twice to check the reduction can be repeated
+  auto reduceSumSquaresBound = reduceSumSquares.Bind(input, output);
+  device->Execute(
+      [&](CommandEncoder& command)
+      {
+        reduceSumSquaresBound.Record(command);
+        reduceSumSquaresBound.Record(command);
+      });
+
+  CopyTo(output, outputData);
+
+  float sum = 0.0f;
+  for (auto& value : inputData)
+  {
+    sum += value.x * value.x;
+  }
+
+  EXPECT_FLOAT_EQ(sum, outputData[0].x);
+  EXPECT_FLOAT_EQ(0.25f * size, outputData[0].y);
+}
+
 TEST(LinearSolverTests, Transfer_Prolongate)
 {
   glm::ivec2 coarseSize(2);
@@ -271,6 +357,55 @@ TEST(LinearSolverTests, Complex_SOR)
   std::cout << "Solved with number of iterations: " << params.OutIterations << std::endl;
 }
 
+TEST(LinearSolverTests, GaussSeidel_Tiled)
+{
+  glm::ivec2 size(50);
+
+  FluidSim sim;
+  sim.initialize(1.0f, size.x, size.y);
+  sim.set_boundary(boundary_phi);
+
+  AddParticles(size, sim, boundary_phi);
+
+  sim.add_force(0.01f);
+  sim.compute_phi();
+  sim.extrapolate_phi();
+  sim.apply_projection(0.01f);
+
+  LinearSolver::Data data(*device, size, MemoryUsage::Cpu);
+  Buffer<float> pressure(*device, size.x * size.y, MemoryUsage::Cpu);
+
+  BuildLinearEquation(size, data.Diagonal, data.Lower, data.B, sim);
+
+  GaussSeidel solver(*device, size);
+  GaussSeidel tiledSolver(*device, size);
+
+  solver.Bind(data.Diagonal, data.Lower, data.B, data.X);
+  tiledSolver.Bind(data.Diagonal, data.Lower, data.B, pressure);
+
+  // odd number of tiled dispatches and remaining iteration
+  device->Execute(
+      [&](CommandEncoder& command)
+      {
+        data.X.Clear(command);
+        pressure.Clear(command);
+        for (int i = 0; i < 7; i++)
+        {
+          solver.Record(command, 1);
+        }
+        tiledSolver.Record(command, 7);
+      });
+
+  std::vector<float> expected(size.x * size.y), result(size.x * size.y);
+  CopyTo(data.X, expected);
+  CopyTo(pressure, result);
+
+  for (std::size_t i = 0; i < expected.size(); i++)
+  {
+    EXPECT_NEAR(expected[i], result[i], 1e-5f) << "index " << i;
+  }
+}
+
 TEST(LinearSolverTests, LocalGaussSeidel)
 {
   glm::ivec2 size(16);  // maximum size
@@ -434,6 +569,55 @@ TEST(LinearSolverTests, Zero_PCG)
   }
 }
 
+TEST(LinearSolverTests, Transfer_Restrict_Half)
+{
+  // odd coarse width, so packed elements span two rows
+  glm::ivec2 coarseSize(3, 2);
+  glm::ivec2 fineSize(6, 4);
+  int coarseCount = coarseSize.x * coarseSize.y;
+  int coarseElements = LinearSolver::GetElementCount(coarseCount, LinearSolver::Precision::Half);
+
+  Transfer t(*device);
+
+  Buffer<float> fineDiagonal(*device, fineSize.x * fineSize.y, MemoryUsage::Cpu);
+  std::vector<float> fineDiagonalData(fineSize.x * fineSize.y, {1.0f});
+  CopyFrom(fineDiagonal, fineDiagonalData);
+
+  Buffer<std::uint32_t> coarseDiagonal(*device, coarseElements, MemoryUsage::Cpu);
+  std::vector<std::uint32_t> coarseDiagonalData(coarseElements,
+                                                glm::packHalf2x16(glm::vec2(1.0f)));
+  CopyFrom(coarseDiagonal, coarseDiagonalData);
+
+  Buffer<float> input(*device, fineSize.x * fineSize.y, MemoryUsage::Cpu);
+  Buffer<std::uint32_t> output(*device, coarseElements, MemoryUsage::Cpu);
+
+  std::vector<float> data(fineSize.x * fineSize.y, 1.0f);
+  std::iota(data.begin(), data.end(), 1.0f);
+  CopyFrom(input, data);
+
+  t.RestrictBind(0,
+                 fineSize,
+                 input,
+                 fineDiagonal,
+                 output,
+                 coarseDiagonal,
+                 LinearSolver::Precision::Single,
+                 LinearSolver::Precision::Half);
+  device->Execute([&](CommandEncoder& command) { t.Restrict(command, 0); });
+
+  std::vector<std::uint32_t> outputData(coarseElements);
+  CopyTo(output, outputData);
+
+  for (int i = 0; i < coarseCount; i++)
+  {
+    int x = i % coarseSize.x;
+    int y = i / coarseSize.x;
+    float expected = 4.5f + 2.0f * x + 2.0f * fineSize.x * y;
+    float value = glm::unpackHalf2x16(outputData[i / 2])[i % 2];
+    EXPECT_FLOAT_EQ(expected, value) << "Mismatch at " << x << ", " << y;
+  }
+}
+
 TEST(LinearSolverTests, Multigrid_Simple_PCG)
 {
   glm::ivec2 size(64);
@@ -481,6 +665,158 @@ TEST(LinearSolverTests, Multigrid_Simple_PCG)
   std::cout << "Solved with number of iterations: " << params.OutIterations << std::endl;
 }
 
+// max of |b - Ax| on the cells of the linear equations, same as Residual.comp
+float GetMaxResidual(const glm::ivec2& size, LinearSolver::Data& data)
+{
+  int n = size.x * size.y;
+  std::vector<float> diagonal(n), b(n), x(n);
+  std::vector<glm::vec2> lower(n);
+  CopyTo(data.Diagonal, diagonal);
+  CopyTo(data.Lower, lower);
+  CopyTo(data.B, b);
+  CopyTo(data.X, x);
+
+  float maxResidual = 0.0f;
+  for (int i = 1; i < size.x - 1; i++)
+  {
+    for (int j = 1; j < size.y - 1; j++)
+    {
+      int index = i + j * size.x;
+      if (diagonal[index] != 0.0f)
+      {
+        float ax = diagonal[index] * x[index] + lower[index + 1].x * x[index + 1] +
+                   lower[index].x * x[index - 1] + lower[index + size.x].y * x[index + size.x] +
+                   lower[index].y * x[index - size.x];
+        maxResidual = std::max(maxResidual, std::abs(b[index] - ax));
+      }
+    }
+  }
+
+  return maxResidual;
+}
+
+TEST(LinearSolverTests, Multigrid_Refinement_PCG)
+{
+  glm::ivec2 size(64);
+
+  FluidSim sim;
+  sim.initialize(1.0f, size.x, size.y);
+  sim.set_boundary(boundary_phi);
+
+  AddParticles(size, sim, boundary_phi);
+
+  sim.add_force(0.01f);
+  sim.compute_phi();
+  sim.extrapolate_phi();
+  sim.apply_projection(0.01f);
+
+  LinearSolver::Data data(*device, size, MemoryUsage::Cpu);
+
+  Velocity velocity(*device, size);
+  Texture liquidPhi(*device, size.x, size.y, Format::R32Sfloat);
+  Texture solidPhi(*device, size.x, size.y, Format::R32Sfloat);
+  Buffer<glm::ivec2> valid(*device, size.x * size.y, MemoryUsage::Cpu);
+
+  SetSolidPhi(*device, size, solidPhi, sim, (float)size.x);
+  SetLiquidPhi(*device, size, liquidPhi, sim, (float)size.x);
+
+  BuildLinearEquation(size, data.Diagonal, data.Lower, data.B, sim);
+
+  Pressure pressure(*device, 0.01f, size, data, velocity, solidPhi, liquidPhi, valid);
+
+  Multigrid preconditioner(*device,
+                           size,
+                           0.01f,
+                           3,
+                           Multigrid::SmootherSolver::Jacobi,
+                           LinearSolver::Precision::Half);
+  preconditioner.BuildHierarchiesBind(pressure, solidPhi, liquidPhi);
+
+  LinearSolver::Parameters params(LinearSolver::Parameters::SolverType::Iterative, 1000, 1e-5f);
+  ConjugateGradient solver(*device, size, preconditioner);
+
+  solver.Bind(data.Diagonal, data.Lower, data.B, data.X);
+
+  preconditioner.BuildHierarchies();
+
+  // the updated residual drifts with the half precision preconditioner
+  solver.Solve(params);
+  device->WaitIdle();
+
+  EXPECT_LE(params.OutError, params.ErrorTolerance);
+  EXPECT_GT(GetMaxResidual(size, data), params.ErrorTolerance);
+
+  solver.SetRefinementSteps(2);
+  solver.Solve(params);
+  device->WaitIdle();
+
+  EXPECT_LE(GetMaxResidual(size, data), params.ErrorTolerance);
+
+  CheckPressure(size, sim.pressure, data.X, 1e-5f);
+
+  std::cout << "Solved with number of iterations: " << params.OutIterations << std::endl;
+}
+
+TEST(LinearSolverTests, Multigrid_Half_Iterations_PCG)
+{
+  glm::ivec2 size(64);
+
+  FluidSim sim;
+  sim.initialize(1.0f, size.x, size.y);
+  sim.set_boundary(boundary_phi);
+
+  AddParticles(size, sim, boundary_phi);
+
+  sim.add_force(0.01f);
+  sim.compute_phi();
+  sim.extrapolate_phi();
+  sim.apply_projection(0.01f);
+
+  LinearSolver::Data data(*device, size, MemoryUsage::Cpu);
+
+  Velocity velocity(*device, size);
+  Texture liquidPhi(*device, size.x, size.y, Format::R32Sfloat);
+  Texture solidPhi(*device, size.x, size.y, Format::R32Sfloat);
+  Buffer<glm::ivec2> valid(*device, size.x * size.y, MemoryUsage::Cpu);
+
+  SetSolidPhi(*device, size, solidPhi, sim, (float)size.x);
+  SetLiquidPhi(*device, size, liquidPhi, sim, (float)size.x);
+
+  BuildLinearEquation(size, data.Diagonal, data.Lower, data.B, sim);
+
+  Pressure pressure(*device, 0.01f, size, data, velocity, solidPhi, liquidPhi, valid);
+
+  // same solve with the hierarchy in single and in half precision
+  auto solve = [&](LinearSolver::Precision precision)
+  {
+    Multigrid preconditioner(
+        *device, size, 0.01f, 3, Multigrid::SmootherSolver::Jacobi, precision);
+    preconditioner.BuildHierarchiesBind(pressure, solidPhi, liquidPhi);
+
+    LinearSolver::Parameters params(
+        LinearSolver::Parameters::SolverType::Iterative, 1000, 1e-5f);
+    ConjugateGradient solver(*device, size, preconditioner);
+    solver.Bind(data.Diagonal, data.Lower, data.B, data.X);
+
+    preconditioner.BuildHierarchies();
+    solver.Solve(params);
+    device->WaitIdle();
+
+    CheckPressure(size, sim.pressure, data.X, 1e-4f);
+
+    return params.OutIterations;
+  };
+
+  unsigned singleIterations = solve(LinearSolver::Precision::Single);
+  unsigned halfIterations = solve(LinearSolver::Precision::Half);
+
+  std::cout << "Solved with number of iterations: " << singleIterations << " (single), "
+            << halfIterations << " (half)" << std::endl;
+
+  // the half precision hierarchy only costs a few more iterations
+  EXPECT_LE(halfIterations, singleIterations + singleIterations / 2 + 1);
+}
+
 TEST(LinearSolverTests, Multigrid_Simple)
 {
   glm::ivec2 size(64);
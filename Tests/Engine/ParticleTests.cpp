@@ -159,6 +159,63 @@ TEST(ParticleTests, PrefixScanBig)
   EXPECT_EQ(params.workSize.z, 1);
 }
 
+TEST(ParticleTests, PrefixScanBigMultiLevel)
+{
+  int size = 10000;
+
+  PrefixScan prefixScan(*device, size, PrefixScan::Mode::MultiLevel);
+
+  Buffer<int> input(*device, size, MemoryUsage::Cpu);
+  Buffer<int> output(*device, size, MemoryUsage::Cpu);
+  Buffer<DispatchParams> dispatchParams(*device, 1, MemoryUsage::Cpu);
+
+  std::vector<int> inputData = GenerateInput(size);
+  CopyFrom(input, inputData);
+
+  auto bound = prefixScan.Bind(input, output, dispatchParams);
+
+  device->Execute([&](CommandEncoder& command) { bound.Record(command); });
+
+  auto outputData = CalculatePrefixScan(inputData);
+  CheckBuffer(outputData, output);
+
+  DispatchParams params(0);
+  CopyTo(dispatchParams, params);
+
+  int total = outputData.back() + inputData.back();
+  EXPECT_EQ(params.count, total);
+}
+
+TEST(ParticleTests, PrefixScanRepeated)
+{
+  int size = 100000;
+
+  PrefixScan prefixScan(*device, size);
+
+  Buffer<int> input(*device, size, MemoryUsage::Cpu);
+  Buffer<int> output(*device, size, MemoryUsage::Cpu);
+  Buffer<DispatchParams> dispatchParams(*device, 1, MemoryUsage::Cpu);
+
+  std::vector<int> inputData = GenerateInput(size);
+  CopyFrom(input, inputData);
+
+  auto bound = prefixScan.Bind(input, output, dispatchParams);
+
+  // tile status needs to be reset between each scan
+  device->Execute([&](CommandEncoder& command) { bound.Record(command); });
+  device->Execute([&](CommandEncoder& command) { bound.Record(command); });
+
+  auto outputData = CalculatePrefixScan(inputData);
+  CheckBuffer(outputData, output);
+
+  DispatchParams params(0);
+  CopyTo(dispatchParams, params);
+
+  int total = outputData.back() + inputData.back();
+  EXPECT_EQ(params.count, total);
+  EXPECT_EQ(params.workSize.x, std::ceil((float)total / 256));
+}
+
 TEST(ParticleTests, ParticleCounting)
 {
   glm::ivec2 size(20);
@@ -179,6 +236,7 @@ TEST(ParticleTests, ParticleCounting)
   device->WaitIdle();
 
   ASSERT_EQ(numParticles, particleCount.GetTotalCount());
+  ASSERT_EQ(numParticles, particleCount.GetLastTotalCount());
 }
 
 TEST(ParticleTests, ParticleCounting_OffBounds)
@@ -272,6 +330,111 @@ TEST(ParticleTests, ParticleClamp)
   ASSERT_EQ(8, particleCount.GetTotalCount());
 }
 
+TEST(ParticleTests, ParticleTileOrder)
+{
+  // size not a multiple of the tile size
+  glm::ivec2 size(20);
+
+  std::vector<Particle> particlesData(size.x * size.y * 8);
+  particlesData[0].Position = glm::vec2(19.5f, 19.5f);
+  particlesData[1].Position = glm::vec2(0.5f, 9.5f);
+  particlesData[2].Position = glm::vec2(9.5f, 0.5f);
+  particlesData[3].Position = glm::vec2(7.5f, 7.5f);
+  particlesData[4].Position = glm::vec2(0.5f, 0.5f);
+  int numParticles = 5;
+
+  Buffer<Particle> particles(*device, 8 * size.x * size.y, MemoryUsage::Cpu);
+  CopyFrom(particles, particlesData);
+
+  ParticleCount particleCount(
+      *device, size, particles, Velocity::InterpolationMode::Cubic, {numParticles});
+
+  particleCount.Scan();
+  device->WaitIdle();
+
+  ASSERT_EQ(numParticles, particleCount.GetTotalCount());
+
+  std::vector<Particle> outParticlesData(size.x * size.y * 8);
+  CopyTo(particles, outParticlesData);
+
+  // Particles are sorted by tiles of 8x8 cells, then row-major within a tile
+  EXPECT_EQ(outParticlesData[0].Position, glm::vec2(0.5f, 0.5f));
+  EXPECT_EQ(outParticlesData[1].Position, glm::vec2(7.5f, 7.5f));
+  EXPECT_EQ(outParticlesData[2].Position, glm::vec2(9.5f, 0.5f));
+  EXPECT_EQ(outParticlesData[3].Position, glm::vec2(0.5f, 9.5f));
+  EXPECT_EQ(outParticlesData[4].Position, glm::vec2(19.5f, 19.5f));
+}
+
+TEST(ParticleTests, ParticleClampPerCell)
+{
+  glm::ivec2 size(20);
+
+  std::vector<Particle> particlesData(size.x * size.y * 4);
+
+  int numParticles = 10;
+  for (int i = 0; i < numParticles; i++)
+  {
+    particlesData[i].Position = glm::vec2(3.4f, 2.3f);
+  }
+
+  Buffer<Particle> particles(*device, 4 * size.x * size.y, MemoryUsage::Cpu);
+  CopyFrom(particles, particlesData);
+
+  ParticleCount particleCount(*device,
+                              size,
+                              particles,
+                              Velocity::InterpolationMode::Cubic,
+                              {numParticles},
+                              1.0f,
+                              DefaultParticleSize(),
+                              4);
+
+  particleCount.Scan();
+  device->WaitIdle();
+
+  ASSERT_EQ(4, particleCount.GetTotalCount());
+}
+
+TEST(ParticleTests, ParticleReserve)
+{
+  glm::ivec2 size(20);
+
+  GenericBuffer particles(*device, BufferUsage::Storage, MemoryUsage::Gpu, 4 * sizeof(Particle));
+  ParticleCount particleCount(*device, size, particles, Velocity::InterpolationMode::Cubic);
+  ASSERT_EQ(4, particleCount.GetCapacity());
+
+  auto rect = std::make_shared<IntRectangle>(*device, glm::vec2{2, 1});
+  rect->Position = glm::vec2(10.0f, 10.0f);
+  rect->Colour = glm::ivec4(4);
+
+  particleCount.Record({rect}).Submit();
+
+  // Not enough space, the particles are not added
+  particleCount.Scan();
+  device->WaitIdle();
+
+  ASSERT_EQ(0, particleCount.GetTotalCount());
+  ASSERT_EQ(8, particleCount.GetRequiredCapacity());
+
+  // Grow and scan again
+  ASSERT_TRUE(particleCount.Reserve(particleCount.GetRequiredCapacity()));
+  ASSERT_EQ(8, particleCount.GetCapacity());
+
+  particleCount.Scan();
+  device->WaitIdle();
+
+  ASSERT_EQ(8, particleCount.GetTotalCount());
+
+  // Growing keeps the particles
+  ASSERT_TRUE(particleCount.Reserve(16));
+  ASSERT_FALSE(particleCount.Reserve(16));
+
+  particleCount.Scan();
+  device->WaitIdle();
+
+  ASSERT_EQ(8, particleCount.GetTotalCount());
+}
+
 TEST(ParticleTests, ParticleSpawn)
 {
   glm::ivec2 size(20);
@@ -320,6 +483,56 @@ TEST(ParticleTests, ParticleSpawn)
   }
 }
 
+TEST(ParticleTests, ParticleSpawnSeed)
+{
+  glm::ivec2 size(20);
+
+  auto spawn = [&](std::uint32_t seed)
+  {
+    Buffer<Particle> particles(*device, 8 * size.x * size.y, MemoryUsage::Cpu);
+    ParticleCount particleCount(*device, size, particles, Velocity::InterpolationMode::Cubic);
+    particleCount.SetSeed(seed);
+
+    auto rect = std::make_shared<IntRectangle>(*device, glm::vec2{4, 4});
+    rect->Position = glm::vec2(10.0f, 10.0f);
+    rect->Colour = glm::ivec4(4);
+
+    // Spawn twice, to check the frame is used
+    particleCount.Record({rect}).Submit();
+    particleCount.Scan();
+    particleCount.Record({rect}).Submit();
+    particleCount.Scan();
+    device->WaitIdle();
+
+    EXPECT_EQ(128, particleCount.GetTotalCount());
+
+    std::vector<Particle> outParticlesData(size.x * size.y * 8);
+    CopyTo(particles, outParticlesData);
+    outParticlesData.resize(128);
+
+    // The order of particles in the same grid cell is not deterministic
+    std::vector<glm::vec2> positions;
+    for (auto& particle : outParticlesData)
+    {
+      positions.push_back(particle.Position);
+    }
+
+    std::sort(positions.begin(),
+              positions.end(),
+              [](const auto& left, const auto& right)
+              { return std::tie(left.x, left.y) < std::tie(right.x, right.y); });
+    return positions;
+  };
+
+  auto positions1 = spawn(1);
+  auto positions2 = spawn(1);
+  auto positions3 = spawn(2);
+
+  EXPECT_EQ(positions1, positions2);
+  EXPECT_NE(positions1, positions3);
+  EXPECT_EQ(std::adjacent_find(positions1.begin(), positions1.end()), positions1.end());
+}
+
 TEST(ParticleTests, ParticleAddDelete)
 {
   glm::ivec2 size(20);
@@ -568,7 +781,6 @@ TEST(ParticleTests, FromGrid_FLIP)
 
   particleCount.VelocitiesBind(velocity, valid);
 
-  velocity.VelocityDiff();
   particleCount.TransferFromGrid();
   device->WaitIdle();
 
@@ -658,3 +870,76 @@ TEST(ParticleTests, ToGrid)
 
   CheckVelocity(*device, size, velocity, sim, 1e-5f);
 }
+
+TEST(ParticleTests, OverflowPhiToGrid)
+{
+  glm::ivec2 size(20);
+
+  float alpha = 1.0f;
+
+  // setup FluidSim
+  FluidSim sim;
+  sim.initialize(1.0f, size.x, size.y);
+  sim.set_boundary(boundary_phi);
+
+  AddParticles(size, sim, boundary_phi);
+
+  sim.advance(0.01f);
+  sim.get_velocity_update();
+  sim.update_from_grid(alpha);
+  sim.v.set_zero();
+  sim.u.set_zero();
+
+  sim.transfer_to_grid();
+  sim.compute_phi();
+
+  // setup ParticleCount with just enough space for the current particles
+  int count = static_cast<int>(sim.particles.size());
+  Buffer<Particle> particles(*device, count, MemoryUsage::Cpu);
+
+  std::vector<Particle> particlesData;
+  for (std::size_t p = 0; p < sim.particles.size(); p++)
+  {
+    Particle particle;
+    particle.Position = glm::vec2(sim.particles[p][0] * size.x, sim.particles[p][1] * size.x);
+    particle.Velocity = glm::vec2(sim.particles_velocity[p][0], sim.particles_velocity[p][1]);
+    particlesData.push_back(particle);
+  }
+  CopyFrom(particles, particlesData);
+
+  ParticleCount particleCount(
+      *device, size, particles, Velocity::InterpolationMode::Cubic, {count}, alpha);
+
+  // Fill every cell, which doesn't fit
+  auto rect = std::make_shared<IntRectangle>(*device, glm::vec2(size));
+  rect->Colour = glm::ivec4(8);
+
+  particleCount.Record({rect}).Submit();
+  particleCount.Scan();
+  device->WaitIdle();
+
+  ASSERT_EQ(count, particleCount.GetCapacity());
+  ASSERT_LT(count, particleCount.GetRequiredCapacity());
+  ASSERT_EQ(count, particleCount.GetTotalCount());
+
+  // The kept particles are used
+  LevelSet phi(*device, size);
+
+  particleCount.LevelSetBind(phi);
+  particleCount.Phi();
+  device->WaitIdle();
+
+  Texture outTexture(*device, size.x, size.y, Format::R32Sfloat, MemoryUsage::Cpu);
+  device->Execute([&](CommandEncoder& command) { outTexture.CopyFrom(command, phi); });
+
+  CheckPhi(size, sim, outTexture);
+
+  Velocity velocity(*device, size);
+  Buffer<glm::ivec2> valid(*device, size.x * size.y, MemoryUsage::Cpu);
+
+  particleCount.VelocitiesBind(velocity, valid);
+  particleCount.TransferToGrid();
+  device->WaitIdle();
+
+  CheckVelocity(*device, size, velocity, sim, 1e-5f);
+}
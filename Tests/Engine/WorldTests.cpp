@@ -6,13 +6,18 @@
 #include <Vortex/Engine/Boundaries.h>
 #include <Vortex/Engine/Cfl.h>
 #include <Vortex/Engine/Density.h>
+#include <Vortex/Engine/FieldCache.h>
+#include <Vortex/Engine/LocalSizeTuner.h>
 #include <Vortex/Engine/Rigidbody.h>
+#include <Vortex/Engine/TimeStep.h>
 #include <Vortex/Engine/World.h>
 #include <gtest/gtest.h>
 #include "VariationalHelpers.h"
 #include "Verify.h"
 
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <random>
 
@@ -206,6 +211,84 @@ TEST(WorldTests, Velocity)
   CheckVelocity(*device, size, world.GetVelocity(), velocityData);
 }
 
+TEST(WorldTests, LastCFL)
+{
+  float dt = 0.01f;
+  glm::vec2 size(64.0f, 64.0f);
+
+  Fluid::SmokeWorld world(*device, size, dt, Fluid::Velocity::InterpolationMode::Cubic);
+  world.SetComputeLastCFL(true);
+
+  auto fluidClear = std::make_shared<Renderer::Clear>(glm::vec4{-1.0f, 0.0f, 0.0f, 0.0f});
+  world.RecordLiquidPhi({fluidClear}).Submit();
+
+  auto velocity = std::make_shared<Renderer::Rectangle>(*device, size);
+  velocity->Colour = {-10.0f, 0.0f, 0.0f, 0.0f};
+
+  world.RecordVelocity({velocity}, Fluid::VelocityOp::Set).Submit();
+
+  auto params = Fluid::IterativeParams(1e-5f);
+  world.Step(params);
+
+  device->WaitIdle();
+
+  EXPECT_NEAR(world.GetCFL(), world.GetLastCFL(), 1e-4f);
+}
+
+std::vector<glm::vec2> HalfPrecision_VelocityTest(Fluid::LinearSolver::Precision precision)
+{
+  float dt = 0.01f;
+  glm::vec2 size(64.0f, 64.0f);
+
+  Fluid::SmokeWorld world(*device, size, dt, Fluid::Velocity::InterpolationMode::Cubic, precision);
+
+  // half float density, advected with the half precision kernels
+  Fluid::Density density(*device, size, Renderer::Format::R16G16B16A16Sfloat);
+  world.FieldBind(density);
+
+  auto obstacle = std::make_shared<Fluid::Circle>(*device, 8.0f);
+  obstacle->Position = {32.0f, 32.0f};
+  world.RecordStaticSolidPhi({Fluid::BoundariesClear, obstacle}).Submit();
+
+  auto fluidClear = std::make_shared<Renderer::Clear>(glm::vec4{-1.0f, 0.0f, 0.0f, 0.0f});
+  world.RecordLiquidPhi({fluidClear}).Submit();
+
+  auto velocity = std::make_shared<Renderer::Rectangle>(*device, size);
+  velocity->Colour = {10.0f, 0.0f, 0.0f, 0.0f};
+
+  world.RecordVelocity({velocity}, Fluid::VelocityOp::Set).Submit();
+
+  auto params = Fluid::IterativeParams(1e-5f);
+  world.Step(params);
+
+  device->WaitIdle();
+
+  Renderer::Texture output(
+      *device, size.x, size.y, Renderer::Format::R32G32Sfloat, Renderer::MemoryUsage::Cpu);
+  device->Execute([&](Renderer::CommandEncoder& command)
+                  { output.CopyFrom(command, world.GetVelocity()); });
+
+  std::vector<glm::vec2> velocityData(size.x * size.y);
+  output.CopyTo(velocityData);
+
+  return velocityData;
+}
+
+TEST(WorldTests, HalfPrecision)
+{
+  // the flow around the obstacle is solved to the same tolerance with the
+  // half precision preconditioner
+  auto expected = HalfPrecision_VelocityTest(Fluid::LinearSolver::Precision::Single);
+  auto velocity = HalfPrecision_VelocityTest(Fluid::LinearSolver::Precision::Half);
+
+  ASSERT_EQ(expected.size(), velocity.size());
+  for (std::size_t i = 0; i < expected.size(); i++)
+  {
+    EXPECT_NEAR(expected[i].x, velocity[i].x, 1e-4f) << "Mismatch at " << i;
+    EXPECT_NEAR(expected[i].y, velocity[i].y, 1e-4f) << "Mismatch at " << i;
+  }
+}
+
 TEST(CflTets, Max)
 {
   glm::ivec2 size(50);
@@ -240,3 +323,243 @@ TEST(CflTets, Max)
   cfl.Compute();
   EXPECT_NEAR(1.0f / (max * size.x), cfl.Get(), 1e-4f);
 }
+
+TEST(CflTets, MaxAsync)
+{
+  glm::ivec2 size(50);
+
+  Fluid::Velocity velocity(*device, size);
+  Fluid::Cfl cfl(*device, size, velocity);
+
+  Renderer::Texture input(
+      *device, size.x, size.y, Renderer::Format::R32G32Sfloat, Renderer::MemoryUsage::Cpu);
+
+  std::vector<glm::vec2> velocityData(size.x * size.y, glm::vec2(0.25f, 0.1f));
+  velocityData[size.x + 3] = glm::vec2(0.5f, 0.2f);
+
+  input.CopyFrom(velocityData);
+  device->Execute([&](Renderer::CommandEncoder& command) { velocity.CopyFrom(command, input); });
+
+  // not computed yet
+  EXPECT_EQ(0.0f, cfl.GetLast());
+
+  cfl.ComputeAsync();
+  device->WaitIdle();
+
+  EXPECT_NEAR(1.0f / (0.5f * size.x), cfl.GetLast(), 1e-4f);
+}
+
+TEST(CflTets, AdaptiveTimeStep)
+{
+  glm::ivec2 size(50);
+
+  Fluid::Velocity velocity(*device, size);
+  Renderer::Buffer<float> timeScale(*device, 1, Renderer::MemoryUsage::GpuToCpu);
+  Fluid::TimeStep timeStep(*device, size, velocity, timeScale, 1.0f, 0.25f, 1.0f, 100);
+
+  EXPECT_EQ(4, timeStep.GetSubSteps());
+
+  Renderer::Texture input(
+      *device, size.x, size.y, Renderer::Format::R32G32Sfloat, Renderer::MemoryUsage::Cpu);
+
+  std::vector<glm::vec2> velocityData(size.x * size.y, glm::vec2(0.25f, 0.1f));
+  velocityData[size.x + 3] = glm::vec2(0.45f, 0.2f);
+
+  input.CopyFrom(velocityData);
+  device->Execute([&](Renderer::CommandEncoder& command) { velocity.CopyFrom(command, input); });
+
+  // largest substep is 1 / (0.45 * 50) = 1 / 22.5
+  float maxDt = 1.0f / 22.5f;
+  timeStep.Begin();
+  timeStep.Substep();
+  device->WaitIdle();
+
+  EXPECT_EQ(23, timeStep.GetSubSteps());
+
+  float scale;
+  Renderer::CopyTo(timeScale, scale);
+  EXPECT_NEAR(maxDt / 0.25f, scale, 1e-5f);
+
+  // only one substep was done
+  EXPECT_NEAR(1.0f - maxDt, timeStep.GetDroppedTime(), 1e-5f);
+
+  // the last substep does what's left of the step
+  for (int i = 1; i < 23; i++)
+  {
+    timeStep.Substep();
+  }
+  device->WaitIdle();
+
+  Renderer::CopyTo(timeScale, scale);
+  EXPECT_NEAR((1.0f - 22.0f * maxDt) / 0.25f, scale, 1e-4f);
+  EXPECT_NEAR(0.0f, timeStep.GetDroppedTime(), 1e-5f);
+
+  // substeps past the step have a size of zero
+  timeStep.Substep();
+  device->WaitIdle();
+
+  Renderer::CopyTo(timeScale, scale);
+  EXPECT_EQ(0.0f, scale);
+}
+
+TEST(CflTets, AdaptiveTimeStepRounding)
+{
+  glm::ivec2 size(50);
+
+  Fluid::Velocity velocity(*device, size);
+  Renderer::Buffer<float> timeScale(*device, 1, Renderer::MemoryUsage::GpuToCpu);
+  Fluid::TimeStep timeStep(*device, size, velocity, timeScale, 1.0f, 0.25f, 1.0f, 100);
+
+  Renderer::Texture input(
+      *device, size.x, size.y, Renderer::Format::R32G32Sfloat, Renderer::MemoryUsage::Cpu);
+
+  // the ratio is 15, which can be rounded slightly above in floating point
+  std::vector<glm::vec2> velocityData(size.x * size.y, glm::vec2(0.3f, 0.0f));
+
+  input.CopyFrom(velocityData);
+  device->Execute([&](Renderer::CommandEncoder& command) { velocity.CopyFrom(command, input); });
+
+  timeStep.Begin();
+  device->WaitIdle();
+
+  EXPECT_EQ(15, timeStep.GetSubSteps());
+}
+
+TEST(WorldTests, AdaptiveSubStepsRigidbody)
+{
+  float dt = 0.01f;
+  glm::vec2 size(64.0f, 64.0f);
+
+  Fluid::SmokeWorld world(*device, size, dt, Fluid::Velocity::InterpolationMode::Cubic);
+  world.SetAdaptiveSubSteps(1.0f, 10);
+
+  auto rectangle = std::make_shared<Fluid::Rectangle>(*device, glm::vec2(8.0f));
+  Fluid::RigidBody rigidbody(*device, size, rectangle, Fluid::RigidBody::Type::eWeak);
+
+  EXPECT_THROW(world.AddRigidbody(rigidbody), std::runtime_error);
+}
+
+TEST(WorldTests, FieldCache)
+{
+  glm::ivec2 size(50, 40);
+
+  Fluid::Velocity velocity(*device, size);
+  Renderer::Texture input(
+      *device, size.x, size.y, Renderer::Format::R32G32Sfloat, Renderer::MemoryUsage::Cpu);
+
+  std::vector<glm::vec2> velocityData(size.x * size.y, glm::vec2(0.0f));
+  for (int i = 0; i < 20; i++)
+  {
+    for (int j = 0; j < 30; j++)
+    {
+      velocityData[i + size.x * j] = glm::vec2(i, j);
+    }
+  }
+
+  input.CopyFrom(velocityData);
+  device->Execute([&](Renderer::CommandEncoder& command) { velocity.CopyFrom(command, input); });
+
+  std::vector<Fluid::Particle> particlesData(8 * size.x * size.y);
+  particlesData[0].Position = glm::vec2(3.4f, 2.3f);
+  particlesData[1].Position = glm::vec2(5.4f, 6.7f);
+  int numParticles = 2;
+
+  Renderer::Buffer<Fluid::Particle> particles(
+      *device, 8 * size.x * size.y, Renderer::MemoryUsage::Cpu);
+  Renderer::CopyFrom(particles, particlesData);
+
+  Fluid::ParticleCount particleCount(
+      *device, size, particles, Fluid::Velocity::InterpolationMode::Linear, {numParticles});
+
+  std::string filename = ::testing::TempDir() + "field_cache.bin";
+
+  {
+    Fluid::FieldCacheWriter writer(*device, filename, 16);
+    writer.AddField("velocity", velocity);
+    writer.AddParticles("particles", particles, particleCount);
+
+    writer.WriteFrame();
+    device->Execute([&](Renderer::CommandEncoder& command) { velocity.Clear(command); });
+    writer.WriteFrame();
+  }
+
+  {
+    Fluid::FieldCacheReader reader(filename);
+    EXPECT_EQ(2u, reader.GetFrameCount());
+    EXPECT_EQ(size, reader.GetSize("velocity"));
+
+    std::vector<glm::vec2> outputData;
+    reader.Read(0, "velocity", outputData);
+    EXPECT_EQ(velocityData, outputData);
+
+    reader.Read(1, "velocity", outputData);
+    EXPECT_EQ(std::vector<glm::vec2>(size.x * size.y, glm::vec2(0.0f)), outputData);
+
+    auto outputParticles = reader.ReadParticles(0, "particles");
+    EXPECT_EQ(numParticles, static_cast<int>(outputParticles.size()));
+    if (outputParticles.size() > 1)
+    {
+      EXPECT_EQ(particlesData[1].Position, outputParticles[1].Position);
+    }
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(WorldTests, Checkpoint)
+{
+  float dt = 0.01f;
+  glm::vec2 size(64.0f, 64.0f);
+
+  Fluid::SmokeWorld world(*device, size, dt, Fluid::Velocity::InterpolationMode::Cubic);
+
+  auto fluidClear = std::make_shared<Renderer::Clear>(glm::vec4{-1.0f, 0.0f, 0.0f, 0.0f});
+  world.RecordLiquidPhi({fluidClear}).Submit();
+
+  auto velocity = std::make_shared<Renderer::Rectangle>(*device, size);
+  velocity->Colour = {-10.0f, -10.0f, 0.0f, 0.0f};
+
+  world.RecordVelocity({velocity}, Fluid::VelocityOp::Set).Submit();
+
+  auto params = Fluid::IterativeParams(1e-5f);
+  world.Step(params);
+
+  std::string filename = ::testing::TempDir() + "checkpoint.bin";
+  world.SaveCheckpoint(filename);
+  world.WaitCheckpoint();
+
+  Fluid::SmokeWorld restoredWorld(*device, size, dt, Fluid::Velocity::InterpolationMode::Cubic);
+  restoredWorld.LoadCheckpoint(filename);
+
+  device->WaitIdle();
+  std::remove(filename.c_str());
+
+  float value = 10.0f / size.x;
+  std::vector<glm::vec2> velocityData(size.x * size.y, {-value, -value});
+
+  CheckVelocity(*device, size, restoredWorld.GetVelocity(), velocityData);
+}
+
+TEST(WorldTests, LocalSizeTunerCache)
+{
+  std::string filename = ::testing::TempDir() + "local_sizes_test.txt";
+
+  {
+    std::ofstream file(filename);
+    file << "32 8 128 " << device->GetName() << std::endl;
+  }
+
+  auto localSize2D = Renderer::ComputeSize::GetLocalSize2D();
+  auto localSize1D = Renderer::ComputeSize::GetLocalSize1D();
+
+  Fluid::LocalSizeTuner tuner(*device, filename);
+  tuner.Tune();
+
+  EXPECT_EQ(glm::ivec2(32, 8), Renderer::ComputeSize::GetLocalSize2D());
+  EXPECT_EQ(128, Renderer::ComputeSize::GetLocalSize1D());
+
+  Renderer::ComputeSize::SetLocalSize2D(localSize2D);
+  Renderer::ComputeSize::SetLocalSize1D(localSize1D);
+
+  std::remove(filename.c_str());
+}
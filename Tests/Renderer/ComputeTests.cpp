@@ -52,6 +52,41 @@ TEST(ComputeTests, BufferCopy)
   CheckBuffer(data, outBuffer);
 }
 
+TEST(ComputeTests, TransientBufferCopy)
+{
+  std::vector<float> data1(100, 23.4f);
+  std::vector<float> data2(50, 1.2f);
+
+  TransientMemory memory(*device);
+  Buffer<float> buffer1(*device, data1.size(), memory);
+  Buffer<float> buffer2(*device, data2.size(), memory);
+  memory.Allocate();
+
+  ASSERT_GE(memory.Size(), sizeof(float) * data1.size());
+
+  Buffer<float> inBuffer1(*device, data1.size(), MemoryUsage::Cpu);
+  Buffer<float> inBuffer2(*device, data2.size(), MemoryUsage::Cpu);
+  Buffer<float> outBuffer1(*device, data1.size(), MemoryUsage::Cpu);
+  Buffer<float> outBuffer2(*device, data2.size(), MemoryUsage::Cpu);
+
+  CopyFrom(inBuffer1, data1);
+  CopyFrom(inBuffer2, data2);
+
+  device->Execute(
+      [&](CommandEncoder& command)
+      {
+        buffer1.CopyFrom(command, inBuffer1);
+        outBuffer1.CopyFrom(command, buffer1);
+        buffer2.CopyFrom(command, inBuffer2);
+        outBuffer2.CopyFrom(command, buffer2);
+      });
+
+  CheckBuffer(data1, outBuffer1);
+  CheckBuffer(data2, outBuffer2);
+
+  EXPECT_THROW(buffer1.Resize(10), std::runtime_error);
+}
+
 TEST(ComputeTests, UpdateVectorBuffer)
 {
   int size = 3;
@@ -423,6 +458,19 @@ TEST(ComputeTests, Reflection)
   EXPECT_EQ(12, spirv3.GetPushConstantsSize());
 }
 
+TEST(ComputeTests, ReflectionCache)
+{
+  Reflection spirv1(Checkerboard_comp);
+  Reflection spirv2(Checkerboard_comp);
+
+  EXPECT_EQ(spirv1.GetDescriptorTypesMap(), spirv2.GetDescriptorTypesMap());
+  EXPECT_EQ(spirv1.GetPushConstantsSize(), spirv2.GetPushConstantsSize());
+  EXPECT_EQ(spirv1.GetShaderStage(), spirv2.GetShaderStage());
+
+  Reflection spirv3(Image_comp);
+  EXPECT_NE(spirv1.GetDescriptorTypesMap(), spirv3.GetDescriptorTypesMap());
+}
+
 TEST(ComputeTests, Cache)
 {
   auto shader1 = device->CreateShaderModule(Buffer_comp);
@@ -453,3 +501,18 @@ TEST(ComputeTests, Cache)
   EXPECT_EQ(pipelineLayout2, device->CreatePipelineLayout(layout2));
   EXPECT_EQ(pipeline2, device->CreateComputePipeline(shader2, pipelineLayout2));
 }
+
+TEST(ComputeTests, AsyncCache)
+{
+  auto shader = device->CreateShaderModule(Stencil_comp);
+  Reflection reflection(Stencil_comp);
+
+  ShaderLayouts layout = {reflection};
+  Handle::PipelineLayout pipelineLayout = device->CreatePipelineLayout(layout);
+
+  auto specConst = SpecConst(SpecConstValue(1, 16), SpecConstValue(2, 16));
+
+  auto future = device->CreateComputePipelineAsync(shader, pipelineLayout, specConst);
+  EXPECT_EQ(future.get(), device->CreateComputePipeline(shader, pipelineLayout, specConst));
+  EXPECT_NE(future.get(), device->CreateComputePipeline(shader, pipelineLayout));
+}
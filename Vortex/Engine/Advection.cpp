@@ -8,12 +8,27 @@
 #include <Vortex/Engine/Density.h>
 #include <Vortex/Renderer/Pipeline.h>
 
+#include <algorithm>
+
 #include "vortex_generated_spirv.h"
 
 namespace Vortex
 {
 namespace Fluid
 {
+int LinearFilter(Renderer::Device& device)
+{
+  return device.HasLinearFilter(Renderer::Format::R32G32Sfloat) ? 1 : 0;
+}
+
+// the cubic gathers don't filter, but a linear sampler can only be used on
+// formats supporting it
+Renderer::Sampler::Filter VelocityFilter(Renderer::Device& device)
+{
+  return LinearFilter(device) == 1 ? Renderer::Sampler::Filter::Linear
+                                   : Renderer::Sampler::Filter::Nearest;
+}
+
 Advection::Advection(Renderer::Device& device,
                      const glm::ivec2& size,
                      float dt,
@@ -23,32 +38,109 @@ Advection::Advection(Renderer::Device& device,
     , mDt(dt)
     , mSize(size)
     , mVelocity(velocity)
+    , mTimeScale(device)
+    , mVelocitySampler(device, Renderer::Sampler::AddressMode::ClampToEdge, VelocityFilter(device))
+    , mScheme(Scheme::SemiLagrangian)
     , mVelocityAdvect(device,
                       Renderer::ComputeSize{size},
                       SPIRV::AdvectVelocity_comp,
-                      Renderer::SpecConst(Renderer::SpecConstValue(3, interpolationMode)))
-    , mVelocityAdvectBound(mVelocityAdvect.Bind({velocity, velocity.Output()}))
-    , mAdvect(device, Renderer::ComputeSize{size}, SPIRV::Advect_comp)
+                      Renderer::SpecConst(Renderer::SpecConstValue(3, interpolationMode),
+                                          Renderer::SpecConstValue(4, LinearFilter(device))))
+    , mVelocityCorrect(device,
+                       Renderer::ComputeSize{size},
+                       SPIRV::AdvectVelocityCorrect_comp,
+                       Renderer::SpecConst(Renderer::SpecConstValue(3, interpolationMode),
+                                           Renderer::SpecConstValue(4, LinearFilter(device))))
+    , mAdvect(device,
+              Renderer::ComputeSize{size},
+              SPIRV::Advect_comp,
+              Renderer::SpecConst(Renderer::SpecConstValue(4, LinearFilter(device))))
+    , mAdvectCorrect(device,
+                     Renderer::ComputeSize{size},
+                     SPIRV::AdvectCorrect_comp,
+                     Renderer::SpecConst(Renderer::SpecConstValue(4, LinearFilter(device))))
+    , mAdvectHalf(device,
+                  Renderer::ComputeSize{size},
+                  SPIRV::AdvectHalf_comp,
+                  Renderer::SpecConst(Renderer::SpecConstValue(4, LinearFilter(device))))
+    , mAdvectCorrectHalf(device,
+                         Renderer::ComputeSize{size},
+                         SPIRV::AdvectCorrectHalf_comp,
+                         Renderer::SpecConst(Renderer::SpecConstValue(4, LinearFilter(device))))
     , mAdvectParticles(device,
                        Renderer::ComputeSize::Default1D(),
                        SPIRV::AdvectParticles_comp,
-                       Renderer::SpecConst(Renderer::SpecConstValue(3, interpolationMode)))
+                       Renderer::SpecConst(Renderer::SpecConstValue(3, interpolationMode),
+                                           Renderer::SpecConstValue(4, LinearFilter(device))))
     , mAdvectVelocityCmd(device, false)
     , mAdvectCmd(device, false)
     , mAdvectParticlesCmd(device, false)
 {
+  Renderer::Buffer<float> localTimeScale(device, 1, Renderer::MemoryUsage::Cpu);
+  Renderer::CopyFrom(localTimeScale, 1.0f);
+  device.Execute([&](Renderer::CommandEncoder& command)
+                 { mTimeScale.CopyFrom(command, localTimeScale); });
+
+  RecordAdvectVelocity();
+}
+
+void Advection::SetScheme(Scheme scheme)
+{
+  mScheme = scheme;
+
+  RecordAdvectVelocity();
+  if (!mDensities.empty())
+  {
+    RecordAdvect();
+  }
+}
+
+void Advection::RecordAdvectVelocity()
+{
+  if (mScheme == Scheme::MacCormack)
+  {
+    if (!mVelocityForward)
+    {
+      mVelocityForward = std::make_unique<Renderer::Texture>(
+          mDevice, mSize.x, mSize.y, Renderer::Format::R32G32Sfloat);
+    }
+
+    mVelocityAdvectBound = mVelocityAdvect.Bind(
+        {mVelocity, *mVelocityForward, mTimeScale, {mVelocitySampler, mVelocity}});
+    mVelocityCorrectBound = mVelocityCorrect.Bind({mVelocity,
+                                                   *mVelocityForward,
+                                                   mVelocity.Output(),
+                                                   mTimeScale,
+                                                   {mVelocitySampler, mVelocity}});
+  }
+  else
+  {
+    mVelocityAdvectBound = mVelocityAdvect.Bind(
+        {mVelocity, mVelocity.Output(), mTimeScale, {mVelocitySampler, mVelocity}});
+  }
+
   mAdvectVelocityCmd.Record(
       [&](Renderer::CommandEncoder& command)
       {
         command.DebugMarkerBegin("Velocity advect", {0.15f, 0.46f, 0.19f, 1.0f});
-        mVelocityAdvectBound.PushConstant(command, dt);
+        mVelocityAdvectBound.PushConstant(command, mDt);
         mVelocityAdvectBound.Record(command);
-        velocity.Output().Barrier(command,
-                                  Renderer::ImageLayout::General,
-                                  Renderer::Access::Write,
-                                  Renderer::ImageLayout::General,
-                                  Renderer::Access::Read);
-        velocity.CopyBack(command);
+        if (mScheme == Scheme::MacCormack)
+        {
+          mVelocityForward->Barrier(command,
+                                    Renderer::ImageLayout::General,
+                                    Renderer::Access::Write,
+                                    Renderer::ImageLayout::General,
+                                    Renderer::Access::Read);
+          mVelocityCorrectBound.PushConstant(command, mDt);
+          mVelocityCorrectBound.Record(command);
+        }
+        mVelocity.Output().Barrier(command,
+                                   Renderer::ImageLayout::General,
+                                   Renderer::Access::Write,
+                                   Renderer::ImageLayout::General,
+                                   Renderer::Access::Read);
+        mVelocity.CopyBack(command);
         command.DebugMarkerEnd();
       });
 }
@@ -60,26 +152,172 @@ void Advection::AdvectVelocity()
 
 void Advection::AdvectBind(Density& density)
 {
-  mAdvectBound = mAdvect.Bind({mVelocity, density, density.mFieldBack});
+  glm::ivec2 densitySize(density.GetWidth(), density.GetHeight());
+  int scale = densitySize.x / mSize.x;
+  if (scale < 1 || densitySize != mSize * scale)
+  {
+    throw std::runtime_error("Density size must be a multiple of the velocity size");
+  }
+
+  if (std::find(mDensities.begin(), mDensities.end(), &density) != mDensities.end())
+  {
+    return;
+  }
+
+  mDensities.push_back(&density);
+  RecordAdvect();
+}
+
+void Advection::AdvectUnbind(Density& density)
+{
+  auto it = std::find(mDensities.begin(), mDensities.end(), &density);
+  if (it == mDensities.end())
+  {
+    return;
+  }
+
+  // the forward fields are in the same order as the densities
+  auto index = std::distance(mDensities.begin(), it);
+  if (index < static_cast<std::ptrdiff_t>(mForwardFields.size()))
+  {
+    mForwardFields.erase(mForwardFields.begin() + index);
+  }
+
+  mDensities.erase(it);
+  mAdvectBatches.clear();
+  if (!mDensities.empty())
+  {
+    RecordAdvect();
+  }
+}
+
+void Advection::RecordAdvect()
+{
+  if (mScheme == Scheme::MacCormack)
+  {
+    for (std::size_t i = mForwardFields.size(); i < mDensities.size(); i++)
+    {
+      auto* field = mDensities[i];
+      mForwardFields.push_back(std::make_unique<Renderer::Texture>(
+          mDevice, field->GetWidth(), field->GetHeight(), field->GetFormat()));
+    }
+  }
+
+  // densities of the same size and format are advected together
+  const std::size_t maxBatchSize = 4;
+  mAdvectBatches.clear();
+  for (std::size_t i = 0; i < mDensities.size(); i++)
+  {
+    int scale = mDensities[i]->GetWidth() / mSize.x;
+    bool half = mDensities[i]->GetFormat() == Renderer::Format::R16G16B16A16Sfloat;
+    auto batch = std::find_if(mAdvectBatches.begin(),
+                              mAdvectBatches.end(),
+                              [&](const AdvectBatch& batch) {
+                                return batch.Scale == scale && batch.Half == half &&
+                                       batch.Fields.size() < maxBatchSize;
+                              });
+    if (batch == mAdvectBatches.end())
+    {
+      mAdvectBatches.push_back({{}, scale, half, {}, {}});
+      batch = mAdvectBatches.end() - 1;
+    }
+
+    batch->Fields.push_back(i);
+  }
+
+  for (auto& batch : mAdvectBatches)
+  {
+    // unused fields are bound to the first one and never accessed
+    auto fieldIndex = [&](std::size_t i)
+    { return batch.Fields[i < batch.Fields.size() ? i : 0]; };
+
+    std::vector<Renderer::BindingInput> fields, forwardFields, outFields;
+    for (std::size_t i = 0; i < maxBatchSize; i++)
+    {
+      fields.push_back(*mDensities[fieldIndex(i)]);
+      outFields.push_back(mDensities[fieldIndex(i)]->mFieldBack);
+      if (mScheme == Scheme::MacCormack)
+      {
+        forwardFields.push_back(*mForwardFields[fieldIndex(i)]);
+      }
+    }
+
+    // the velocity size is pushed, the dispatch covers the densities
+    Renderer::ComputeSize computeSize{mSize};
+    computeSize.WorkSize =
+        Renderer::ComputeSize::GetWorkSize(mSize * batch.Scale, computeSize.LocalSize);
+
+    auto& advect = batch.Half ? mAdvectHalf : mAdvect;
+    auto& advectCorrect = batch.Half ? mAdvectCorrectHalf : mAdvectCorrect;
+
+    // MacCormack advects in the forward fields then corrects in the out fields
+    std::vector<Renderer::BindingInput> inputs = {mVelocity, mTimeScale};
+    inputs.insert(inputs.end(), fields.begin(), fields.end());
+    if (mScheme == Scheme::MacCormack)
+    {
+      inputs.insert(inputs.end(), forwardFields.begin(), forwardFields.end());
+      inputs.push_back({mVelocitySampler, mVelocity});
+      batch.Bound = advect.Bind(computeSize, inputs);
+
+      inputs.pop_back();
+      inputs.insert(inputs.end(), outFields.begin(), outFields.end());
+      inputs.push_back({mVelocitySampler, mVelocity});
+      batch.CorrectBound = advectCorrect.Bind(computeSize, inputs);
+    }
+    else
+    {
+      inputs.insert(inputs.end(), outFields.begin(), outFields.end());
+      inputs.push_back({mVelocitySampler, mVelocity});
+      batch.Bound = advect.Bind(computeSize, inputs);
+    }
+  }
+
   mAdvectCmd.Record(
       [&](Renderer::CommandEncoder& command)
       {
         command.DebugMarkerBegin("Density advect", {0.86f, 0.14f, 0.52f, 1.0f});
-        mAdvectBound.PushConstant(command, mDt);
-        mAdvectBound.Record(command);
-        density.mFieldBack.Barrier(command,
-                                   Renderer::ImageLayout::General,
-                                   Renderer::Access::Write,
-                                   Renderer::ImageLayout::General,
-                                   Renderer::Access::Read);
-        density.CopyFrom(command, density.mFieldBack);
+        for (auto& batch : mAdvectBatches)
+        {
+          int count = static_cast<int>(batch.Fields.size());
+          batch.Bound.PushConstant(command, mDt, batch.Scale, count);
+          batch.Bound.Record(command);
+        }
+
+        if (mScheme == Scheme::MacCormack)
+        {
+          for (auto& forwardField : mForwardFields)
+          {
+            forwardField->Barrier(command,
+                                  Renderer::ImageLayout::General,
+                                  Renderer::Access::Write,
+                                  Renderer::ImageLayout::General,
+                                  Renderer::Access::Read);
+          }
+
+          for (auto& batch : mAdvectBatches)
+          {
+            int count = static_cast<int>(batch.Fields.size());
+            batch.CorrectBound.PushConstant(command, mDt, batch.Scale, count);
+            batch.CorrectBound.Record(command);
+          }
+        }
+
+        for (auto* field : mDensities)
+        {
+          field->mFieldBack.Barrier(command,
+                                    Renderer::ImageLayout::General,
+                                    Renderer::Access::Write,
+                                    Renderer::ImageLayout::General,
+                                    Renderer::Access::Read);
+          field->CopyFrom(command, field->mFieldBack);
+        }
         command.DebugMarkerEnd();
       });
 }
 
 void Advection::Advect()
 {
-  if (mAdvectCmd)
+  if (mAdvectCmd && !mDensities.empty())
   {
     mAdvectCmd.Submit();
   }
@@ -90,8 +328,14 @@ void Advection::AdvectParticleBind(
     Renderer::Texture& levelSet,
     Renderer::IndirectBuffer<Renderer::DispatchParams>& dispatchParams)
 {
-  mAdvectParticlesBound = mAdvectParticles.Bind(Renderer::ComputeSize{mSize},
-                                                {particles, dispatchParams, mVelocity, levelSet});
+  mAdvectParticlesBound =
+      mAdvectParticles.Bind(Renderer::ComputeSize{mSize},
+                            {particles,
+                             dispatchParams,
+                             mVelocity,
+                             levelSet,
+                             mTimeScale,
+                             {mVelocitySampler, mVelocity}});
   mAdvectParticlesCmd.Record(
       [&](Renderer::CommandEncoder& command)
       {
@@ -108,5 +352,10 @@ void Advection::AdvectParticles()
   mAdvectParticlesCmd.Submit();
 }
 
+Renderer::GenericBuffer& Advection::GetTimeScale()
+{
+  return mTimeScale;
+}
+
 }  // namespace Fluid
 }  // namespace Vortex
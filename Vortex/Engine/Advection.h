@@ -23,12 +23,27 @@ class Density;
 class Advection
 {
 public:
+  /**
+   * @brief Scheme used to advect the velocity and density fields.
+   */
+  enum class Scheme
+  {
+    /// single semi-Lagrangian advection
+    SemiLagrangian,
+    /// semi-Lagrangian advections forward and backward, the error is
+    /// corrected and clamped to the values around the departure point
+    MacCormack,
+  };
+
   /**
    * @brief Initialize advection kernels and related object.
    * @param device vulkan device
    * @param size size of velocity field
    * @param dt delta time for integration
    * @param velocity velocity field
+   * @param interpolationMode linear interpolation uses hardware filtering
+   * when the device supports it for the velocity format, cubic interpolation
+   * gathers its samples, with a nearest sampler if the device doesn't
    */
   VORTEX_API Advection(Renderer::Device& device,
                        const glm::ivec2& size,
@@ -41,13 +56,35 @@ public:
    */
   VORTEX_API void AdvectVelocity();
 
-  // TODO can only advect one field, need to be able to do as many as we want
   /**
-   * @brief Binds a density field to be advected.
+   * @brief Change the scheme used by @ref AdvectVelocity and @ref Advect,
+   * semi-Lagrangian by default. MacCormack is second order, allowing a
+   * coarser grid for the same quality, at the cost of two extra passes and a
+   * scratch texture per field.
+   * @param scheme the advection scheme
+   */
+  VORTEX_API void SetScheme(Scheme scheme);
+
+  /**
+   * @brief Binds a density field to be advected, in addition to the ones
+   * already bound. The size of the density can be an integer multiple of the
+   * velocity size, for a finer density. The density is stored in 8 bits per
+   * channel, or in half floats with the R16G16B16A16Sfloat format. Densities
+   * of the same size and format are advected together, up to 4 in one
+   * dispatch. Binding a density already
+   * bound does nothing. The density must stay alive until it is unbound with
+   * @ref AdvectUnbind or the advection is destroyed.
    * @param density density field
    */
   VORTEX_API void AdvectBind(Density& density);
 
+  /**
+   * @brief Unbinds a density field, which won't be advected anymore. Unbinding
+   * a density that isn't bound does nothing.
+   * @param density density field
+   */
+  VORTEX_API void AdvectUnbind(Density& density);
+
   /**
    * @brief Performs an advection of the density field. Asynchronous operation.
    */
@@ -69,16 +106,46 @@ public:
    */
   VORTEX_API void AdvectParticles();
 
+  /**
+   * @brief Buffer containing a single float which scales dt, set to 1. It can
+   * be written on the device to change the time step without recording the
+   * advections again.
+   */
+  VORTEX_API Renderer::GenericBuffer& GetTimeScale();
+
 private:
+  struct AdvectBatch
+  {
+    std::vector<std::size_t> Fields;
+    int Scale;
+    bool Half;
+    Renderer::Work::Bound Bound;
+    Renderer::Work::Bound CorrectBound;
+  };
+
+  void RecordAdvectVelocity();
+  void RecordAdvect();
+
   Renderer::Device& mDevice;
   float mDt;
   glm::ivec2 mSize;
   Velocity& mVelocity;
+  Renderer::Buffer<float> mTimeScale;
+  Renderer::Sampler mVelocitySampler;
+  Scheme mScheme;
 
   Renderer::Work mVelocityAdvect;
   Renderer::Work::Bound mVelocityAdvectBound;
+  Renderer::Work mVelocityCorrect;
+  Renderer::Work::Bound mVelocityCorrectBound;
+  std::unique_ptr<Renderer::Texture> mVelocityForward;
   Renderer::Work mAdvect;
-  Renderer::Work::Bound mAdvectBound;
+  Renderer::Work mAdvectCorrect;
+  Renderer::Work mAdvectHalf;
+  Renderer::Work mAdvectCorrectHalf;
+  std::vector<Density*> mDensities;
+  std::vector<std::unique_ptr<Renderer::Texture>> mForwardFields;
+  std::vector<AdvectBatch> mAdvectBatches;
   Renderer::Work mAdvectParticles;
   Renderer::Work::Bound mAdvectParticlesBound;
 
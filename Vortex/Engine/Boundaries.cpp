@@ -29,7 +29,8 @@ bool IsClockwise(const std::vector<glm::vec2>& points)
   return total > 0.0;
 }
 
-std::vector<glm::vec2> GetBoundingBox(const std::vector<glm::vec2>& points, float extent)
+// top left and bottom right corners
+glm::vec4 GetBounds(const std::vector<glm::vec2>& points, float extent)
 {
   glm::vec2 topLeft(std::numeric_limits<float>::max());
   glm::vec2 bottomRight(std::numeric_limits<float>::min());
@@ -46,6 +47,15 @@ std::vector<glm::vec2> GetBoundingBox(const std::vector<glm::vec2>& points, floa
   topLeft -= glm::vec2(extent);
   bottomRight += glm::vec2(extent);
 
+  return {topLeft, bottomRight};
+}
+
+std::vector<glm::vec2> GetBoundingBox(const std::vector<glm::vec2>& points, float extent)
+{
+  glm::vec4 bounds = GetBounds(points, extent);
+  glm::vec2 topLeft(bounds.x, bounds.y);
+  glm::vec2 bottomRight(bounds.z, bounds.w);
+
   return {{topLeft.x, topLeft.y},
           {bottomRight.x, topLeft.y},
           {topLeft.x, bottomRight.y},
@@ -228,6 +238,132 @@ void Circle::Draw(Renderer::CommandEncoder& command, const Renderer::RenderState
   command.Draw(6);
 }
 
+ShapeBatch::ShapeBatch(Renderer::Device& device,
+                       std::uint32_t maxShapes,
+                       std::uint32_t maxPoints,
+                       float extent)
+    : mDevice(device)
+    , mMaxShapes(maxShapes)
+    , mMaxPoints(maxPoints)
+    , mExtent(extent)
+    , mPointCount(0)
+    , mUniformBuffer(device, Renderer::MemoryUsage::CpuToGpu)
+    , mShapeBuffer(device, maxShapes, Renderer::MemoryUsage::CpuToGpu)
+    , mPointBuffer(device, std::max(maxPoints, 1u), Renderer::MemoryUsage::CpuToGpu)
+{
+  mShapes.reserve(maxShapes);
+
+  SPIRV::Reflection reflectionVert(SPIRV::ShapeBatch_vert);
+  SPIRV::Reflection reflectionFrag(SPIRV::ShapeBatchDist_frag);
+
+  SPIRV::ShaderLayouts layout = {reflectionVert, reflectionFrag};
+
+  mPipelineLayout = mDevice.CreatePipelineLayout(layout);
+  auto bindGroupLayout = mDevice.CreateBindGroupLayout(layout);
+  mBindGroup = mDevice.CreateBindGroup(
+      bindGroupLayout, layout, {{mUniformBuffer}, {mShapeBuffer}, {mPointBuffer}});
+
+  mPipeline =
+      Renderer::GraphicsPipelineDescriptor()
+          .Topology(Renderer::PrimitiveTopology::Triangle)
+          .Shader(mDevice.CreateShaderModule(SPIRV::ShapeBatch_vert),
+                  Renderer::ShaderStage::Vertex)
+          .Shader(mDevice.CreateShaderModule(SPIRV::ShapeBatchDist_frag),
+                  Renderer::ShaderStage::Fragment)
+          .Layout(mPipelineLayout);
+}
+
+ShapeBatch::~ShapeBatch() {}
+
+std::uint32_t ShapeBatch::AddCircle(float radius)
+{
+  std::vector<glm::vec2> points = {
+      {-radius, -radius}, {radius, -radius}, {radius, radius}, {-radius, radius}};
+
+  return Add({glm::mat4(1.0f), GetBounds(points, mExtent), radius, 0, 0, 0});
+}
+
+std::uint32_t ShapeBatch::AddPolygon(std::vector<glm::vec2> points, bool inverse)
+{
+  assert(!IsClockwise(points));
+  if (inverse)
+  {
+    std::reverse(points.begin(), points.end());
+  }
+
+  auto count = static_cast<std::uint32_t>(points.size());
+  if (mPointCount + count > mMaxPoints)
+  {
+    throw std::runtime_error("Too many polygon points in shape batch");
+  }
+
+  auto index = Add(
+      {glm::mat4(1.0f), GetBounds(points, mExtent), 0.0f, mPointCount, count, inverse ? 1u : 0u});
+
+  mPointBuffer.CopyFrom(static_cast<std::uint32_t>(mPointCount * sizeof(glm::vec2)),
+                        points.data(),
+                        static_cast<std::uint32_t>(count * sizeof(glm::vec2)));
+  mPointCount += count;
+
+  return index;
+}
+
+std::uint32_t ShapeBatch::AddRectangle(const glm::vec2& size, bool inverse)
+{
+  return AddPolygon({{0.0f, 0.0f}, {size.x, 0.0f}, {size.x, size.y}, {0.0f, size.y}}, inverse);
+}
+
+std::uint32_t ShapeBatch::Add(const Shape& shape)
+{
+  if (mShapes.size() == mMaxShapes)
+  {
+    throw std::runtime_error("Too many shapes in shape batch");
+  }
+
+  mShapes.push_back(shape);
+  return static_cast<std::uint32_t>(mShapes.size() - 1);
+}
+
+void ShapeBatch::SetTransform(std::uint32_t index, const glm::mat4& transform)
+{
+  mShapes.at(index).Transform = transform;
+}
+
+void ShapeBatch::Reset()
+{
+  mShapes.clear();
+  mPointCount = 0;
+}
+
+void ShapeBatch::Initialize(const Renderer::RenderState& renderState)
+{
+  mDevice.CreateGraphicsPipeline(mPipeline, renderState);
+}
+
+void ShapeBatch::Update(const glm::mat4& projection, const glm::mat4& view)
+{
+  Uniforms uniforms;
+  uniforms.Projection = projection;
+  uniforms.View = view;
+  uniforms.Count = static_cast<std::int32_t>(mShapes.size());
+  Renderer::CopyFrom(mUniformBuffer, uniforms);
+
+  if (!mShapes.empty())
+  {
+    mShapeBuffer.CopyFrom(
+        0, mShapes.data(), static_cast<std::uint32_t>(mShapes.size() * sizeof(Shape)));
+  }
+}
+
+void ShapeBatch::Draw(Renderer::CommandEncoder& command, const Renderer::RenderState& renderState)
+{
+  auto pipeline = mDevice.CreateGraphicsPipeline(mPipeline, renderState);
+
+  command.SetPipeline(Renderer::PipelineBindPoint::Graphics, pipeline);
+  command.SetBindGroup(Renderer::PipelineBindPoint::Graphics, mPipelineLayout, mBindGroup);
+  command.Draw(6, mMaxShapes);
+}
+
 Renderer::ColorBlendState IntersectionBlend = Renderer::ColorBlendState(Renderer::BlendFactor::One,
                                                                         Renderer::BlendFactor::One,
                                                                         Renderer::BlendOp::Max);
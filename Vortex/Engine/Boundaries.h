@@ -120,6 +120,105 @@ private:
   Renderer::GraphicsPipelineDescriptor mPipeline;
 };
 
+/**
+ * @brief Signed distance fields of many circles, polygons and rectangles drawn
+ * with a single instanced draw, instead of one drawable per shape. The
+ * transforms and parameters of the shapes are in one buffer, written when the
+ * render command is submitted.
+ */
+class ShapeBatch : public Renderer::Drawable
+{
+public:
+  /**
+   * @brief Initialize an empty batch.
+   * @param device vulkan device.
+   * @param maxShapes maximum number of shapes in the batch.
+   * @param maxPoints maximum number of points of all the polygons.
+   * @param extent extent how far from the shapes the signed distance field is
+   * calculated.
+   */
+  VORTEX_API ShapeBatch(Renderer::Device& device,
+                        std::uint32_t maxShapes,
+                        std::uint32_t maxPoints = 0,
+                        float extent = 10.0f);
+
+  VORTEX_API ~ShapeBatch() override;
+
+  /**
+   * @brief Add a circle, see @ref Circle.
+   * @param radius radius of circle.
+   * @return index of the shape, used to set its transform.
+   */
+  VORTEX_API std::uint32_t AddCircle(float radius);
+
+  /**
+   * @brief Add a polygon, see @ref Polygon.
+   * @param points clockwise oriented set of points (mininum 3).
+   * @param inverse flag if the distance field should be inversed.
+   * @return index of the shape, used to set its transform.
+   */
+  VORTEX_API std::uint32_t AddPolygon(std::vector<glm::vec2> points, bool inverse = false);
+
+  /**
+   * @brief Add a rectangle, see @ref Rectangle.
+   * @param size rectangle size
+   * @param inverse flag if the distance field should be inverted.
+   * @return index of the shape, used to set its transform.
+   */
+  VORTEX_API std::uint32_t AddRectangle(const glm::vec2& size, bool inverse = false);
+
+  /**
+   * @brief Set the transform of a shape, e.g. from @ref
+   * Renderer::Transformable::GetTransform.
+   * @param index index of the shape
+   * @param transform the transform matrix
+   */
+  VORTEX_API void SetTransform(std::uint32_t index, const glm::mat4& transform);
+
+  /**
+   * @brief Remove all the shapes.
+   */
+  VORTEX_API void Reset();
+
+  VORTEX_API void Initialize(const Renderer::RenderState& renderState) override;
+  VORTEX_API void Update(const glm::mat4& projection, const glm::mat4& view) override;
+  VORTEX_API void Draw(Renderer::CommandEncoder& commandEncoder,
+                       const Renderer::RenderState& renderState) override;
+
+private:
+  struct Uniforms
+  {
+    alignas(16) glm::mat4 Projection;
+    alignas(16) glm::mat4 View;
+    alignas(4) std::int32_t Count;
+  };
+
+  struct Shape
+  {
+    alignas(16) glm::mat4 Transform;
+    alignas(16) glm::vec4 Bounds;
+    alignas(4) float Radius;
+    alignas(4) std::uint32_t Offset;
+    alignas(4) std::uint32_t Count;
+    alignas(4) std::uint32_t Inverse;
+  };
+
+  std::uint32_t Add(const Shape& shape);
+
+  Renderer::Device& mDevice;
+  std::uint32_t mMaxShapes;
+  std::uint32_t mMaxPoints;
+  float mExtent;
+  std::vector<Shape> mShapes;
+  std::uint32_t mPointCount;
+  Renderer::UniformBuffer<Uniforms> mUniformBuffer;
+  Renderer::Buffer<Shape> mShapeBuffer;
+  Renderer::Buffer<glm::vec2> mPointBuffer;
+  Renderer::Handle::PipelineLayout mPipelineLayout;
+  Renderer::BindGroup mBindGroup;
+  Renderer::GraphicsPipelineDescriptor mPipeline;
+};
+
 extern VORTEX_API Renderer::ColorBlendState IntersectionBlend;
 extern VORTEX_API Renderer::ColorBlendState UnionBlend;
 extern VORTEX_API std::shared_ptr<Renderer::Clear> BoundariesClear;
@@ -18,11 +18,17 @@ Cfl::Cfl(Renderer::Device& device, const glm::ivec2& size, Velocity& velocity)
     , mVelocityMaxWork(device, Renderer::ComputeSize{size}, SPIRV::VelocityMax_comp)
     , mVelocityMax(device, size.x * size.y)
     , mCfl(device, 1, Renderer::MemoryUsage::GpuToCpu)
+    , mLastCfl(device, 1, Renderer::MemoryUsage::GpuToCpu)
     , mVelocityMaxCmd(device, true)
+    , mVelocityMaxAsyncCmd(device, false)
     , mReduceVelocityMax(device, size.x * size.y)
 {
+  // negative until the first ComputeAsync completes
+  Renderer::CopyFrom(mLastCfl, -1.0f);
+
   mVelocityMaxBound = mVelocityMaxWork.Bind({mVelocity, mVelocityMax});
   mReduceVelocityMaxBound = mReduceVelocityMax.Bind(mVelocityMax, mCfl);
+  mReduceVelocityMaxAsyncBound = mReduceVelocityMax.Bind(mVelocityMax, mLastCfl);
   mVelocityMaxCmd.Record(
       [&](Renderer::CommandEncoder& command)
       {
@@ -32,6 +38,19 @@ Cfl::Cfl(Renderer::Device& device, const glm::ivec2& size, Velocity& velocity)
         mVelocityMax.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
         mReduceVelocityMaxBound.Record(command);
 
+        command.DebugMarkerEnd();
+      });
+
+  mVelocityMaxAsyncCmd.Record(
+      [&](Renderer::CommandEncoder& command)
+      {
+        command.DebugMarkerBegin("CFL", {0.65f, 0.97f, 0.78f, 1.0f});
+
+        mVelocityMaxBound.Record(command);
+        mVelocityMax.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+        mReduceVelocityMaxAsyncBound.Record(command);
+        mLastCfl.Barrier(command, Renderer::Access::Write, Renderer::Access::HostRead);
+
         command.DebugMarkerEnd();
       });
 }
@@ -51,5 +70,22 @@ float Cfl::Get()
   return 1.0f / (cfl * mSize.x);
 }
 
+void Cfl::ComputeAsync()
+{
+  mVelocityMaxAsyncCmd.Submit();
+}
+
+float Cfl::GetLast()
+{
+  float cfl;
+  Renderer::CopyTo(mLastCfl, cfl);
+  if (cfl < 0.0f)
+  {
+    return 0.0f;
+  }
+
+  return 1.0f / (cfl * mSize.x);
+}
+
 }  // namespace Fluid
 }  // namespace Vortex
@@ -35,16 +35,30 @@ public:
    */
   VORTEX_API float Get();
 
+  /**
+   * Compute the CFL number to be read with @ref GetLast. Non-blocking, it can
+   * be submitted as part of each step without waiting on it.
+   */
+  VORTEX_API void ComputeAsync();
+
+  /**
+   * Returns the CFL number of the last completed @ref ComputeAsync.
+   * Non-blocking: it is read from a mapped buffer, so it can lag behind by the
+   * computations still running on the device.
+   * @return cfl number, or 0 if no @ref ComputeAsync has completed yet
+   */
+  VORTEX_API float GetLast();
+
 private:
   Renderer::Device& mDevice;
   glm::ivec2 mSize;
   Velocity& mVelocity;
   Renderer::Work mVelocityMaxWork;
   Renderer::Work::Bound mVelocityMaxBound;
-  Renderer::Buffer<float> mVelocityMax, mCfl;
-  Renderer::CommandBuffer mVelocityMaxCmd;
+  Renderer::Buffer<float> mVelocityMax, mCfl, mLastCfl;
+  Renderer::CommandBuffer mVelocityMaxCmd, mVelocityMaxAsyncCmd;
   ReduceMax mReduceVelocityMax;
-  ReduceMax::Bound mReduceVelocityMaxBound;
+  ReduceMax::Bound mReduceVelocityMaxBound, mReduceVelocityMaxAsyncBound;
 };
 
 }  // namespace Fluid
@@ -18,6 +18,13 @@ namespace Fluid
 class Density : public Renderer::RenderTexture, public Renderer::Sprite
 {
 public:
+  /**
+   * @brief Initialize the density field.
+   * @param device vulkan device
+   * @param size size of the field
+   * @param format format of the field, 8 bits per channel (e.g. R8G8B8A8Unorm)
+   * or half floats (R16G16B16A16Sfloat) for values outside [0, 1].
+   */
   VORTEX_API Density(Renderer::Device& device, const glm::ivec2& size, Renderer::Format format);
 
   friend class Advection;
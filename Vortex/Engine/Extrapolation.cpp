@@ -20,36 +20,68 @@ Extrapolation::Extrapolation(Renderer::Device& device,
     , mVelocity(velocity)
     , mExtrapolateVelocity(device, Renderer::ComputeSize{size}, SPIRV::ExtrapolateVelocity_comp)
     , mExtrapolateVelocityBound(
-          mExtrapolateVelocity.Bind({valid, mValid, velocity, velocity.Output()}))
+          mExtrapolateVelocity.Bind({valid, mValid, velocity, velocity.Output(), velocity.D()}))
     , mExtrapolateVelocityBackBound(
-          mExtrapolateVelocity.Bind({mValid, valid, velocity.Output(), velocity}))
+          mExtrapolateVelocity.Bind({mValid, valid, velocity.Output(), velocity, velocity.D()}))
+    , mExtrapolateVelocitySave(device,
+                               Renderer::ComputeSize{size},
+                               SPIRV::ExtrapolateVelocity_comp,
+                               Renderer::SpecConst(Renderer::SpecConstValue(3, 1)))
+    , mExtrapolateVelocitySaveBound(
+          mExtrapolateVelocitySave.Bind({mValid, valid, velocity.Output(), velocity, velocity.D()}))
     , mConstrainVelocity(device, Renderer::ComputeSize{size}, SPIRV::ConstrainVelocity_comp)
     , mExtrapolateCmd(device, false)
+    , mExtrapolateSaveCmd(device, false)
     , mConstrainCmd(device, false)
 {
-  mExtrapolateCmd.Record(
-      [&, iterations](Renderer::CommandEncoder& command)
-      {
-        command.DebugMarkerBegin("Extrapolate", {0.60f, 0.87f, 0.12f, 1.0f});
-        for (int i = 0; i < iterations / 2; i++)
+  auto record = [&, iterations](Renderer::CommandBuffer& cmd, bool saveCopy)
+  {
+    cmd.Record(
+        [&, iterations, saveCopy](Renderer::CommandEncoder& command)
         {
-          mExtrapolateVelocityBound.Record(command);
-          velocity.Output().Barrier(command,
-                                    Renderer::ImageLayout::General,
-                                    Renderer::Access::Write,
-                                    Renderer::ImageLayout::General,
-                                    Renderer::Access::Read);
-          mValid.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
-          mExtrapolateVelocityBackBound.Record(command);
-          velocity.Barrier(command,
-                           Renderer::ImageLayout::General,
-                           Renderer::Access::Write,
-                           Renderer::ImageLayout::General,
-                           Renderer::Access::Read);
-          valid.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
-        }
-        command.DebugMarkerEnd();
-      });
+          command.DebugMarkerBegin("Extrapolate", {0.60f, 0.87f, 0.12f, 1.0f});
+          for (int i = 0; i < iterations / 2; i++)
+          {
+            bool last = i == iterations / 2 - 1;
+
+            mExtrapolateVelocityBound.Record(command);
+            velocity.Output().Barrier(command,
+                                      Renderer::ImageLayout::General,
+                                      Renderer::Access::Write,
+                                      Renderer::ImageLayout::General,
+                                      Renderer::Access::Read);
+            mValid.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+            if (saveCopy && last)
+            {
+              mExtrapolateVelocitySaveBound.Record(command);
+              velocity.D().Barrier(command,
+                                   Renderer::ImageLayout::General,
+                                   Renderer::Access::Write,
+                                   Renderer::ImageLayout::General,
+                                   Renderer::Access::Read);
+            }
+            else
+            {
+              mExtrapolateVelocityBackBound.Record(command);
+            }
+            velocity.Barrier(command,
+                             Renderer::ImageLayout::General,
+                             Renderer::Access::Write,
+                             Renderer::ImageLayout::General,
+                             Renderer::Access::Read);
+            valid.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+          }
+
+          if (saveCopy && iterations / 2 == 0)
+          {
+            velocity.D().CopyFrom(command, velocity);
+          }
+          command.DebugMarkerEnd();
+        });
+  };
+
+  record(mExtrapolateCmd, false);
+  record(mExtrapolateSaveCmd, true);
 }
 
 void Extrapolation::Extrapolate()
@@ -57,6 +89,11 @@ void Extrapolation::Extrapolate()
   mExtrapolateCmd.Submit();
 }
 
+void Extrapolation::ExtrapolateSaveCopy()
+{
+  mExtrapolateSaveCmd.Submit();
+}
+
 void Extrapolation::ConstrainBind(Renderer::Texture& solidPhi)
 {
   mConstrainVelocityBound = mConstrainVelocity.Bind({solidPhi, mVelocity, mVelocity.Output()});
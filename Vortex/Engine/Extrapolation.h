@@ -33,6 +33,13 @@ public:
    */
   VORTEX_API void Extrapolate();
 
+  /**
+   * @brief Same as @ref Extrapolate, the last iteration also writes the
+   * extrapolated velocity to @ref Velocity::D, instead of a separate
+   * @ref Velocity::SaveCopy.
+   */
+  VORTEX_API void ExtrapolateSaveCopy();
+
   /**
    * @brief Binds a solid level set to use later and constrain the velocity
    * against
@@ -53,10 +60,13 @@ private:
 
   Renderer::Work mExtrapolateVelocity;
   Renderer::Work::Bound mExtrapolateVelocityBound, mExtrapolateVelocityBackBound;
+  Renderer::Work mExtrapolateVelocitySave;
+  Renderer::Work::Bound mExtrapolateVelocitySaveBound;
   Renderer::Work mConstrainVelocity;
   Renderer::Work::Bound mConstrainVelocityBound;
 
   Renderer::CommandBuffer mExtrapolateCmd;
+  Renderer::CommandBuffer mExtrapolateSaveCmd;
   Renderer::CommandBuffer mConstrainCmd;
 };
 
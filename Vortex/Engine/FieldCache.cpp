@@ -0,0 +1,537 @@
+//
+//  FieldCache.cpp
+//  Vortex
+//
+
+#include "FieldCache.h"
+
+#include <algorithm>
+
+namespace Vortex
+{
+namespace Fluid
+{
+namespace
+{
+const char HeaderMagic[4] = {'V', 'X', 'F', 'C'};
+const char FooterMagic[4] = {'V', 'X', 'F', 'I'};
+const std::uint32_t Version = 1;
+const std::size_t NumSlots = 2;
+
+template <typename T>
+void WriteValue(std::vector<std::uint8_t>& output, const T& value)
+{
+  auto data = reinterpret_cast<const std::uint8_t*>(&value);
+  output.insert(output.end(), data, data + sizeof(T));
+}
+
+template <typename T>
+void WriteValue(std::ostream& output, const T& value)
+{
+  output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T ReadValue(std::istream& input)
+{
+  T value;
+  input.read(reinterpret_cast<char*>(&value), sizeof(T));
+  if (!input)
+    throw std::runtime_error("Error reading field cache");
+  return value;
+}
+
+enum class TileEncoding : std::uint8_t
+{
+  Raw = 0,
+  Constant = 1,
+};
+
+}  // namespace
+
+FieldCacheWriter::FieldCacheWriter(Renderer::Device& device,
+                                   const std::string& filename,
+                                   std::uint32_t tileSize)
+    : mDevice(device)
+    , mFile(filename, std::ios::binary | std::ios::trunc)
+    , mTileSize(tileSize)
+    , mNextSlot(0)
+    , mQuit(false)
+{
+  if (!mFile)
+    throw std::runtime_error("Cannot open field cache " + filename);
+  if (tileSize == 0)
+    throw std::runtime_error("Invalid tile size");
+}
+
+FieldCacheWriter::~FieldCacheWriter()
+{
+  if (mSlots.empty())
+    Initialise();
+
+  Flush();
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mQuit = true;
+  }
+  mCondition.notify_all();
+  mThread.join();
+
+  for (auto offset : mFrameOffsets)
+  {
+    WriteValue(mFile, offset);
+  }
+  WriteValue(mFile, static_cast<std::uint64_t>(mFrameOffsets.size()));
+  mFile.write(FooterMagic, sizeof(FooterMagic));
+}
+
+void FieldCacheWriter::AddField(const std::string& name, Renderer::Texture& field)
+{
+  if (!mSlots.empty())
+    throw std::runtime_error("Cannot add fields after writing frames");
+
+  mFields.push_back({name, FieldType::Texture, &field, nullptr, nullptr});
+}
+
+void FieldCacheWriter::AddParticles(const std::string& name,
+                                    Renderer::GenericBuffer& particles,
+                                    ParticleCount& count)
+{
+  if (!mSlots.empty())
+    throw std::runtime_error("Cannot add fields after writing frames");
+
+  mFields.push_back({name, FieldType::Particles, nullptr, &particles, &count});
+}
+
+void FieldCacheWriter::AddBuffer(const std::string& name, Renderer::GenericBuffer& buffer)
+{
+  if (!mSlots.empty())
+    throw std::runtime_error("Cannot add fields after writing frames");
+
+  mFields.push_back({name, FieldType::Buffer, nullptr, &buffer, nullptr});
+}
+
+void FieldCacheWriter::Initialise()
+{
+  mFile.write(HeaderMagic, sizeof(HeaderMagic));
+  WriteValue(mFile, Version);
+  WriteValue(mFile, mTileSize);
+  WriteValue(mFile, static_cast<std::uint32_t>(mFields.size()));
+  for (auto& field : mFields)
+  {
+    WriteValue(mFile, static_cast<std::uint32_t>(field.Name.size()));
+    mFile.write(field.Name.data(), field.Name.size());
+    WriteValue(mFile, field.Type);
+    if (field.Type == FieldType::Texture)
+    {
+      WriteValue(mFile, field.Texture->GetFormat());
+      WriteValue(mFile, glm::ivec2(field.Texture->GetWidth(), field.Texture->GetHeight()));
+    }
+    else if (field.Type == FieldType::Buffer)
+    {
+      WriteValue(mFile, Renderer::Format::R8Uint);
+      WriteValue(mFile, glm::ivec2(static_cast<int>(field.Buffer->Size()), 1));
+    }
+    else
+    {
+      WriteValue(mFile, Renderer::Format::R32G32B32A32Sfloat);
+      WriteValue(mFile, glm::ivec2(0));
+    }
+  }
+
+  for (std::size_t i = 0; i < NumSlots; i++)
+  {
+    Slot slot{Renderer::CommandBuffer(mDevice), {}, {}, {}};
+    for (auto& field : mFields)
+    {
+      if (field.Type == FieldType::Texture)
+      {
+        slot.Textures.push_back(std::make_unique<Renderer::Texture>(mDevice,
+                                                                    field.Texture->GetWidth(),
+                                                                    field.Texture->GetHeight(),
+                                                                    field.Texture->GetFormat(),
+                                                                    Renderer::MemoryUsage::Cpu));
+        slot.Buffers.push_back(nullptr);
+        slot.Params.push_back(nullptr);
+      }
+      else
+      {
+        slot.Textures.push_back(nullptr);
+        slot.Buffers.push_back(
+            std::make_unique<Renderer::GenericBuffer>(mDevice,
+                                                      Renderer::BufferUsage::Storage,
+                                                      Renderer::MemoryUsage::GpuToCpu,
+                                                      field.Buffer->Size()));
+        if (field.Type == FieldType::Particles)
+        {
+          slot.Params.push_back(std::make_unique<Renderer::Buffer<Renderer::DispatchParams>>(
+              mDevice, 1, Renderer::MemoryUsage::GpuToCpu));
+        }
+        else
+        {
+          slot.Params.push_back(nullptr);
+        }
+      }
+    }
+
+    slot.Copy.Record(
+        [&](Renderer::CommandEncoder& command)
+        {
+          command.DebugMarkerBegin("Field cache", {0.42f, 0.63f, 0.18f, 1.0f});
+          for (std::size_t j = 0; j < mFields.size(); j++)
+          {
+            if (mFields[j].Type == FieldType::Texture)
+            {
+              slot.Textures[j]->CopyFrom(command, *mFields[j].Texture);
+            }
+            else
+            {
+              slot.Buffers[j]->CopyFrom(command, *mFields[j].Buffer);
+            }
+
+            if (mFields[j].Type == FieldType::Particles)
+            {
+              slot.Params[j]->CopyFrom(command, mFields[j].Count->GetDispatchParams());
+            }
+          }
+          command.DebugMarkerEnd();
+        });
+
+    mSlots.push_back(std::move(slot));
+    mBusy.push_back(false);
+  }
+
+  mThread = std::thread(&FieldCacheWriter::Run, this);
+}
+
+void FieldCacheWriter::WriteFrame()
+{
+  if (mSlots.empty())
+    Initialise();
+
+  std::size_t index;
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    index = mNextSlot;
+    mCondition.wait(lock, [&] { return !mBusy[index]; });
+    mBusy[index] = true;
+    mNextSlot = (mNextSlot + 1) % mSlots.size();
+  }
+
+  mSlots[index].Copy.Submit();
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mQueue.push_back(index);
+  }
+  mCondition.notify_all();
+}
+
+void FieldCacheWriter::Flush()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mCondition.wait(lock, [&] { return mQueue.empty(); });
+  mFile.flush();
+}
+
+void FieldCacheWriter::Run()
+{
+  std::vector<std::uint8_t> output;
+  while (true)
+  {
+    std::size_t index;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [&] { return mQuit || !mQueue.empty(); });
+      if (mQueue.empty())
+        return;
+
+      index = mQueue.front();
+    }
+
+    mSlots[index].Copy.Wait();
+
+    output.clear();
+    Encode(mSlots[index], output);
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mBusy[index] = false;
+    }
+    mCondition.notify_all();
+
+    mFrameOffsets.push_back(static_cast<std::uint64_t>(mFile.tellp()));
+    mFile.write(reinterpret_cast<const char*>(output.data()), output.size());
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mQueue.pop_front();
+    }
+    mCondition.notify_all();
+  }
+}
+
+void FieldCacheWriter::Encode(Slot& slot, std::vector<std::uint8_t>& output)
+{
+  std::vector<std::uint8_t> data;
+  for (std::size_t i = 0; i < mFields.size(); i++)
+  {
+    // size of the field is written once encoded, to allow skipping fields
+    std::size_t sizeOffset = output.size();
+    WriteValue(output, std::uint64_t(0));
+
+    if (mFields[i].Type == FieldType::Texture)
+    {
+      auto& texture = *slot.Textures[i];
+      std::uint32_t width = texture.GetWidth();
+      std::uint32_t height = texture.GetHeight();
+      std::size_t bytesPerPixel = Renderer::GetBytesPerPixel(texture.GetFormat());
+
+      data.resize(width * height * bytesPerPixel);
+      texture.CopyTo(data.data());
+
+      for (std::uint32_t tileY = 0; tileY < height; tileY += mTileSize)
+      {
+        for (std::uint32_t tileX = 0; tileX < width; tileX += mTileSize)
+        {
+          std::uint32_t tileWidth = std::min(mTileSize, width - tileX);
+          std::uint32_t tileHeight = std::min(mTileSize, height - tileY);
+          std::size_t rowSize = tileWidth * bytesPerPixel;
+
+          const std::uint8_t* first = &data[(tileY * width + tileX) * bytesPerPixel];
+          bool constant = true;
+          for (std::uint32_t y = 0; y < tileHeight && constant; y++)
+          {
+            const std::uint8_t* row = &data[((tileY + y) * width + tileX) * bytesPerPixel];
+            for (std::uint32_t x = 0; x < tileWidth && constant; x++)
+            {
+              constant = std::equal(first, first + bytesPerPixel, row + x * bytesPerPixel);
+            }
+          }
+
+          if (constant)
+          {
+            output.push_back(static_cast<std::uint8_t>(TileEncoding::Constant));
+            output.insert(output.end(), first, first + bytesPerPixel);
+          }
+          else
+          {
+            output.push_back(static_cast<std::uint8_t>(TileEncoding::Raw));
+            for (std::uint32_t y = 0; y < tileHeight; y++)
+            {
+              const std::uint8_t* row = &data[((tileY + y) * width + tileX) * bytesPerPixel];
+              output.insert(output.end(), row, row + rowSize);
+            }
+          }
+        }
+      }
+    }
+    else if (mFields[i].Type == FieldType::Buffer)
+    {
+      auto& buffer = *slot.Buffers[i];
+      std::size_t offset = output.size();
+      output.resize(offset + buffer.Size());
+      buffer.CopyTo(0, &output[offset], static_cast<std::uint32_t>(buffer.Size()));
+    }
+    else
+    {
+      Renderer::DispatchParams params(0);
+      Renderer::CopyTo(*slot.Params[i], params);
+
+      auto& buffer = *slot.Buffers[i];
+      std::uint32_t count =
+          std::min<std::uint32_t>(params.count, buffer.Size() / sizeof(Particle));
+      WriteValue(output, count);
+
+      std::size_t offset = output.size();
+      output.resize(offset + count * sizeof(Particle));
+      buffer.CopyTo(0, &output[offset], count * sizeof(Particle));
+    }
+
+    std::uint64_t size = output.size() - sizeOffset - sizeof(std::uint64_t);
+    std::memcpy(&output[sizeOffset], &size, sizeof(size));
+  }
+}
+
+FieldCacheReader::FieldCacheReader(const std::string& filename)
+    : mFile(filename, std::ios::binary)
+{
+  if (!mFile)
+    throw std::runtime_error("Cannot open field cache " + filename);
+
+  char magic[4];
+  mFile.read(magic, sizeof(magic));
+  if (!mFile || !std::equal(magic, magic + 4, HeaderMagic))
+    throw std::runtime_error("Invalid field cache " + filename);
+
+  if (ReadValue<std::uint32_t>(mFile) != Version)
+    throw std::runtime_error("Unsupported field cache version");
+
+  mTileSize = ReadValue<std::uint32_t>(mFile);
+  auto fieldCount = ReadValue<std::uint32_t>(mFile);
+  for (std::uint32_t i = 0; i < fieldCount; i++)
+  {
+    Field field;
+    field.Name.resize(ReadValue<std::uint32_t>(mFile));
+    mFile.read(&field.Name[0], field.Name.size());
+    field.Type = ReadValue<std::uint32_t>(mFile);
+    field.Format = ReadValue<Renderer::Format>(mFile);
+    field.Size = ReadValue<glm::ivec2>(mFile);
+    mFields.push_back(field);
+  }
+
+  mFile.seekg(-static_cast<std::streamoff>(sizeof(std::uint64_t) + sizeof(FooterMagic)),
+              std::ios::end);
+  auto frameCount = ReadValue<std::uint64_t>(mFile);
+  mFile.read(magic, sizeof(magic));
+  if (!mFile || !std::equal(magic, magic + 4, FooterMagic))
+    throw std::runtime_error("Missing frame index in field cache " + filename);
+
+  mFile.seekg(-static_cast<std::streamoff>((frameCount + 1) * sizeof(std::uint64_t) +
+                                           sizeof(FooterMagic)),
+              std::ios::end);
+  for (std::uint64_t i = 0; i < frameCount; i++)
+  {
+    mFrameOffsets.push_back(ReadValue<std::uint64_t>(mFile));
+  }
+}
+
+std::size_t FieldCacheReader::GetFrameCount() const
+{
+  return mFrameOffsets.size();
+}
+
+bool FieldCacheReader::HasField(const std::string& name) const
+{
+  return std::any_of(
+      mFields.begin(), mFields.end(), [&](const Field& field) { return field.Name == name; });
+}
+
+glm::ivec2 FieldCacheReader::GetSize(const std::string& name) const
+{
+  std::size_t index;
+  return Find(name, index).Size;
+}
+
+Renderer::Format FieldCacheReader::GetFormat(const std::string& name) const
+{
+  std::size_t index;
+  return Find(name, index).Format;
+}
+
+const FieldCacheReader::Field& FieldCacheReader::Find(const std::string& name,
+                                                      std::size_t& index) const
+{
+  auto it = std::find_if(
+      mFields.begin(), mFields.end(), [&](const Field& field) { return field.Name == name; });
+  if (it == mFields.end())
+    throw std::runtime_error("Unknown field " + name);
+
+  index = std::distance(mFields.begin(), it);
+  return *it;
+}
+
+std::uint64_t FieldCacheReader::Seek(std::size_t frame, std::size_t index)
+{
+  if (frame >= mFrameOffsets.size())
+    throw std::runtime_error("Invalid frame");
+
+  mFile.clear();
+  mFile.seekg(mFrameOffsets[frame]);
+  for (std::size_t i = 0; i < index; i++)
+  {
+    auto size = ReadValue<std::uint64_t>(mFile);
+    mFile.seekg(size, std::ios::cur);
+  }
+
+  return ReadValue<std::uint64_t>(mFile);
+}
+
+void FieldCacheReader::Read(std::size_t frame,
+                            const std::string& name,
+                            std::vector<std::uint8_t>& data)
+{
+  std::size_t index;
+  auto& field = Find(name, index);
+  if (field.Type != 0)
+    throw std::runtime_error("Field " + name + " is not a texture");
+
+  Seek(frame, index);
+
+  std::uint32_t width = field.Size.x;
+  std::uint32_t height = field.Size.y;
+  std::size_t bytesPerPixel = Renderer::GetBytesPerPixel(field.Format);
+  data.resize(width * height * bytesPerPixel);
+
+  std::vector<std::uint8_t> value(bytesPerPixel);
+  for (std::uint32_t tileY = 0; tileY < height; tileY += mTileSize)
+  {
+    for (std::uint32_t tileX = 0; tileX < width; tileX += mTileSize)
+    {
+      std::uint32_t tileWidth = std::min(mTileSize, width - tileX);
+      std::uint32_t tileHeight = std::min(mTileSize, height - tileY);
+      std::size_t rowSize = tileWidth * bytesPerPixel;
+
+      auto encoding = static_cast<TileEncoding>(ReadValue<std::uint8_t>(mFile));
+      if (encoding == TileEncoding::Constant)
+      {
+        mFile.read(reinterpret_cast<char*>(value.data()), bytesPerPixel);
+      }
+
+      for (std::uint32_t y = 0; y < tileHeight; y++)
+      {
+        std::uint8_t* row = &data[((tileY + y) * width + tileX) * bytesPerPixel];
+        if (encoding == TileEncoding::Constant)
+        {
+          for (std::uint32_t x = 0; x < tileWidth; x++)
+          {
+            std::copy(value.begin(), value.end(), row + x * bytesPerPixel);
+          }
+        }
+        else
+        {
+          mFile.read(reinterpret_cast<char*>(row), rowSize);
+        }
+      }
+    }
+  }
+
+  if (!mFile)
+    throw std::runtime_error("Error reading field " + name);
+}
+
+std::vector<Particle> FieldCacheReader::ReadParticles(std::size_t frame, const std::string& name)
+{
+  std::size_t index;
+  auto& field = Find(name, index);
+  if (field.Type != 1)
+    throw std::runtime_error("Field " + name + " is not particles");
+
+  Seek(frame, index);
+
+  std::vector<Particle> particles(ReadValue<std::uint32_t>(mFile));
+  mFile.read(reinterpret_cast<char*>(particles.data()), particles.size() * sizeof(Particle));
+  if (!mFile)
+    throw std::runtime_error("Error reading field " + name);
+
+  return particles;
+}
+
+void FieldCacheReader::ReadBuffer(std::size_t frame,
+                                  const std::string& name,
+                                  std::vector<std::uint8_t>& data)
+{
+  std::size_t index;
+  auto& field = Find(name, index);
+  if (field.Type != 2)
+    throw std::runtime_error("Field " + name + " is not a buffer");
+
+  data.resize(Seek(frame, index));
+  mFile.read(reinterpret_cast<char*>(data.data()), data.size());
+  if (!mFile)
+    throw std::runtime_error("Error reading field " + name);
+}
+
+}  // namespace Fluid
+}  // namespace Vortex
@@ -0,0 +1,211 @@
+//
+//  FieldCache.h
+//  Vortex
+//
+
+#pragma once
+
+#include <Vortex/Engine/Particles.h>
+#include <Vortex/Renderer/Buffer.h>
+#include <Vortex/Renderer/CommandBuffer.h>
+#include <Vortex/Renderer/Device.h>
+#include <Vortex/Renderer/Texture.h>
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Vortex
+{
+namespace Fluid
+{
+/**
+ * @brief Writes frames of fields (velocity, density, level sets, particles) to
+ * a chunked binary file. Fields are read back asynchronously from the GPU and
+ * the encoding and writing to disk is done on a background thread. Each field
+ * is split in tiles, and tiles with a constant value are stored as a single
+ * value.
+ */
+class FieldCacheWriter
+{
+public:
+  VORTEX_API FieldCacheWriter(Renderer::Device& device,
+                              const std::string& filename,
+                              std::uint32_t tileSize = 32);
+
+  VORTEX_API ~FieldCacheWriter();
+
+  /**
+   * @brief Add a field to be written every frame. All fields need to be added
+   * before the first call to @ref WriteFrame.
+   * @param name the name of the field, used to read it back.
+   * @param field the texture (e.g. @ref Velocity, @ref Density or @ref LevelSet).
+   */
+  VORTEX_API void AddField(const std::string& name, Renderer::Texture& field);
+
+  /**
+   * @brief Add the particles to be written every frame. Only the valid
+   * particles are written, using the count from the dispatch parameters.
+   * @param name the name of the field, used to read it back.
+   * @param particles the particle buffer
+   * @param count the particle count associated with the buffer
+   */
+  VORTEX_API void AddParticles(const std::string& name,
+                               Renderer::GenericBuffer& particles,
+                               ParticleCount& count);
+
+  /**
+   * @brief Add a buffer to be written every frame, stored as is.
+   * @param name the name of the field, used to read it back.
+   * @param buffer the buffer
+   */
+  VORTEX_API void AddBuffer(const std::string& name, Renderer::GenericBuffer& buffer);
+
+  /**
+   * @brief Record the copy of all fields and queue the frame to be written.
+   * Only blocks if all staging slots are still being written.
+   */
+  VORTEX_API void WriteFrame();
+
+  /**
+   * @brief Wait for all the queued frames to be written to disk.
+   */
+  VORTEX_API void Flush();
+
+private:
+  enum class FieldType : std::uint32_t
+  {
+    Texture = 0,
+    Particles = 1,
+    Buffer = 2,
+  };
+
+  struct Field
+  {
+    std::string Name;
+    FieldType Type;
+    Renderer::Texture* Texture;
+    Renderer::GenericBuffer* Buffer;
+    ParticleCount* Count;
+  };
+
+  struct Slot
+  {
+    Renderer::CommandBuffer Copy;
+    std::vector<std::unique_ptr<Renderer::Texture>> Textures;
+    std::vector<std::unique_ptr<Renderer::GenericBuffer>> Buffers;
+    std::vector<std::unique_ptr<Renderer::Buffer<Renderer::DispatchParams>>> Params;
+  };
+
+  void Initialise();
+  void Run();
+  void Encode(Slot& slot, std::vector<std::uint8_t>& output);
+
+  Renderer::Device& mDevice;
+  std::ofstream mFile;
+  std::uint32_t mTileSize;
+  std::vector<Field> mFields;
+  std::vector<Slot> mSlots;
+  std::vector<std::uint64_t> mFrameOffsets;
+
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  std::deque<std::size_t> mQueue;
+  std::vector<bool> mBusy;
+  std::size_t mNextSlot;
+  bool mQuit;
+  std::thread mThread;
+};
+
+/**
+ * @brief Reads the file written by @ref FieldCacheWriter. Any frame can be
+ * read directly using the frame index stored at the end of the file.
+ */
+class FieldCacheReader
+{
+public:
+  VORTEX_API FieldCacheReader(const std::string& filename);
+
+  /**
+   * @brief Number of frames in the file
+   */
+  VORTEX_API std::size_t GetFrameCount() const;
+
+  /**
+   * @brief Check if the file contains a field with the given name
+   */
+  VORTEX_API bool HasField(const std::string& name) const;
+
+  /**
+   * @brief Size of the field with the given name
+   */
+  VORTEX_API glm::ivec2 GetSize(const std::string& name) const;
+
+  /**
+   * @brief Format of the field with the given name
+   */
+  VORTEX_API Renderer::Format GetFormat(const std::string& name) const;
+
+  /**
+   * @brief Read the raw data of a field for a given frame.
+   * @param frame index of the frame
+   * @param name name of the field
+   * @param data width*height*bytesPerPixel amount of data
+   */
+  VORTEX_API void Read(std::size_t frame, const std::string& name, std::vector<std::uint8_t>& data);
+
+  /**
+   * @brief Read the particles for a given frame.
+   * @param frame index of the frame
+   * @param name name of the field
+   * @return the valid particles
+   */
+  VORTEX_API std::vector<Particle> ReadParticles(std::size_t frame, const std::string& name);
+
+  /**
+   * @brief Read the content of a buffer for a given frame.
+   * @param frame index of the frame
+   * @param name name of the field
+   * @param data the content of the buffer
+   */
+  VORTEX_API void ReadBuffer(std::size_t frame,
+                             const std::string& name,
+                             std::vector<std::uint8_t>& data);
+
+  template <typename T>
+  void Read(std::size_t frame, const std::string& name, std::vector<T>& data)
+  {
+    auto size = GetSize(name);
+    if (sizeof(T) != Renderer::GetBytesPerPixel(GetFormat(name)))
+      throw std::runtime_error("Invalid output data format");
+
+    std::vector<std::uint8_t> bytes;
+    Read(frame, name, bytes);
+    data.resize(size.x * size.y);
+    std::memcpy(data.data(), bytes.data(), bytes.size());
+  }
+
+private:
+  struct Field
+  {
+    std::string Name;
+    std::uint32_t Type;
+    Renderer::Format Format;
+    glm::ivec2 Size;
+  };
+
+  const Field& Find(const std::string& name, std::size_t& index) const;
+  std::uint64_t Seek(std::size_t frame, std::size_t index);
+
+  std::ifstream mFile;
+  std::uint32_t mTileSize;
+  std::vector<Field> mFields;
+  std::vector<std::uint64_t> mFrameOffsets;
+};
+
+}  // namespace Fluid
+}  // namespace Vortex
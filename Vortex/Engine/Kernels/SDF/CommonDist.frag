@@ -0,0 +1,45 @@
+// +1 if is left
+float orientation(vec2 a, vec2 b, vec2 p)
+{
+  float v = ((b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x));
+  if (v >= 0.0)
+    return 1.0;
+  else
+    return -1.0;
+}
+
+float dist_to_segment(vec2 a, vec2 b, vec2 c)
+{
+  vec2 ab = b - a;
+  vec2 ac = c - a;
+  vec2 bc = c - b;
+
+  float e = dot(ac, ab);
+  float d;
+
+  if (e <= 0.0)
+  {
+    d = dot(ac, ac);
+  }
+  else
+  {
+    float f = dot(ab, ab);
+    if (e >= f)
+    {
+      d = dot(bc, bc);
+    }
+    else
+    {
+      d = dot(ac, ac) - e * e / f;
+    }
+  }
+
+  if (d < 1e-5)
+  {
+    return 0.0;
+  }
+  else
+  {
+    return sqrt(d);
+  }
+}
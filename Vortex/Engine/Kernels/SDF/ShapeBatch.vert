@@ -0,0 +1,62 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+out gl_PerVertex
+{
+  vec4 gl_Position;
+};
+
+layout(set = 0, binding = 0) uniform UBO
+{
+  mat4 projection;
+  mat4 view;
+  int count;
+}
+u;
+
+struct Shape
+{
+  mat4 transform;
+  vec4 bounds;
+  float radius;
+  uint offset;
+  uint count;
+  uint inverse;
+};
+
+layout(std430, binding = 1) readonly buffer Shapes
+{
+  Shape value[];
+}
+shapes;
+
+layout(location = 0) flat out mat4 v_mv;
+layout(location = 4) flat out float v_radius;
+layout(location = 5) flat out uvec3 v_polygon;
+
+const vec2 corners[6] = vec2[](vec2(0.0, 0.0),
+                               vec2(1.0, 0.0),
+                               vec2(0.0, 1.0),
+                               vec2(1.0, 0.0),
+                               vec2(1.0, 1.0),
+                               vec2(0.0, 1.0));
+
+void main()
+{
+  // the draw is recorded for the maximum number of shapes, the unused
+  // instances are degenerate
+  if (gl_InstanceIndex >= u.count)
+  {
+    gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+    return;
+  }
+
+  Shape shape = shapes.value[gl_InstanceIndex];
+
+  v_mv = u.view * shape.transform;
+  v_radius = shape.radius;
+  v_polygon = uvec3(shape.offset, shape.count, shape.inverse);
+
+  vec2 position = mix(shape.bounds.xy, shape.bounds.zw, corners[gl_VertexIndex]);
+  gl_Position = u.projection * v_mv * vec4(position, 0.0, 1.0);
+}
@@ -0,0 +1,56 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_GOOGLE_include_directive : enable
+
+layout(std430, binding = 2) readonly buffer Points
+{
+  vec2 value[];
+}
+points;
+
+layout(location = 0) flat in mat4 v_mv;
+layout(location = 4) flat in float v_radius;
+// offset, count and inverse of the polygon, count is 0 for a circle
+layout(location = 5) flat in uvec3 v_polygon;
+
+layout(location = 0) out vec4 out_colour;
+
+#include "CommonDist.frag"
+
+const float max_dist = 100000.0;
+
+float circle_dist(vec2 pos)
+{
+  vec2 p = (v_mv * vec4(0.0, 0.0, 0.0, 1.0)).xy;
+  float scale = length(v_mv[0]);
+  return length(p - pos) - v_radius * scale;
+}
+
+float polygon_dist(vec2 pos)
+{
+  uint offset = v_polygon.x;
+  int n = int(v_polygon.y);
+  bool inv = v_polygon.z == 1;
+
+  float value = (inv ? 1.0 : -1.0) * max_dist;
+  for (int i = n - 1, j = 0; j < n; i = j++)
+  {
+    vec2 a = (v_mv * vec4(points.value[offset + i], 0.0, 1.0)).xy;
+    vec2 b = (v_mv * vec4(points.value[offset + j], 0.0, 1.0)).xy;
+
+    float udist = dist_to_segment(a, b, pos);
+    float dist = -orientation(a, b, pos) * udist;
+
+    value = inv ? min(value, dist) : max(value, dist);
+  }
+
+  return value;
+}
+
+void main(void)
+{
+  vec2 pos = gl_FragCoord.xy - vec2(0.5);
+  float value = v_polygon.y == 0 ? circle_dist(pos) : polygon_dist(pos);
+
+  out_colour = vec4(value);
+}
@@ -14,6 +14,25 @@ namespace Vortex
 {
 namespace Fluid
 {
+namespace
+{
+// number of iterations done in one dispatch of the tiled version
+const int tiledIterations = 4;
+
+Renderer::ComputeSize MakeTiledComputeSize(const glm::ivec2& size)
+{
+  // same as in RedistanceTiled.comp
+  glm::ivec2 localSize(16);
+  glm::ivec2 tileSize = 2 * localSize - glm::ivec2(2 * tiledIterations);
+
+  Renderer::ComputeSize computeSize(size);
+  computeSize.LocalSize = localSize;
+  computeSize.WorkSize = Renderer::ComputeSize::GetWorkSize(size, tileSize);
+
+  return computeSize;
+}
+}  // namespace
+
 LevelSet::LevelSet(Renderer::Device& device, const glm::ivec2& size, int reinitializeIterations)
     : Renderer::RenderTexture(device, size.x, size.y, Renderer::Format::R32Sfloat)
     , mDevice(device)
@@ -24,6 +43,14 @@ LevelSet::LevelSet(Renderer::Device& device, const glm::ivec2& size, int reiniti
     , mRedistance(device, Renderer::ComputeSize{size}, SPIRV::Redistance_comp)
     , mRedistanceFront(mRedistance.Bind({{mSampler, mLevelSet0}, {mSampler, *this}, mLevelSetBack}))
     , mRedistanceBack(mRedistance.Bind({{mSampler, mLevelSet0}, {mSampler, mLevelSetBack}, *this}))
+    , mRedistanceTiled(device,
+                       MakeTiledComputeSize(size),
+                       SPIRV::RedistanceTiled_comp,
+                       Renderer::SpecConst(Renderer::SpecConstValue(3, tiledIterations)))
+    , mRedistanceTiledFront(
+          mRedistanceTiled.Bind({{mSampler, mLevelSet0}, {mSampler, *this}, mLevelSetBack}))
+    , mRedistanceTiledBack(
+          mRedistanceTiled.Bind({{mSampler, mLevelSet0}, {mSampler, mLevelSetBack}, *this}))
     , mExtrapolateCmd(device, false)
     , mReinitialiseCmd(device, false)
 {
@@ -34,7 +61,29 @@ LevelSet::LevelSet(Renderer::Device& device, const glm::ivec2& size, int reiniti
 
         mLevelSet0.CopyFrom(command, *this);
 
-        for (int i = 0; i < reinitializeIterations / 2; i++)
+        // pairs of tiled dispatches, each doing several iterations in shared
+        // memory, then the remaining iterations with the global version
+        int tiledCount = reinitializeIterations / (2 * tiledIterations);
+        for (int i = 0; i < tiledCount; i++)
+        {
+          mRedistanceTiledFront.PushConstant(command, 0.1f);
+          mRedistanceTiledFront.Record(command);
+          mLevelSetBack.Barrier(command,
+                                Renderer::ImageLayout::General,
+                                Renderer::Access::Write,
+                                Renderer::ImageLayout::General,
+                                Renderer::Access::Read);
+          mRedistanceTiledBack.PushConstant(command, 0.1f);
+          mRedistanceTiledBack.Record(command);
+          Barrier(command,
+                  Renderer::ImageLayout::General,
+                  Renderer::Access::Write,
+                  Renderer::ImageLayout::General,
+                  Renderer::Access::Read);
+        }
+
+        int remaining = reinitializeIterations - tiledCount * 2 * tiledIterations;
+        for (int i = 0; i < remaining / 2; i++)
         {
           mRedistanceFront.PushConstant(command, 0.1f);
           mRedistanceFront.Record(command);
@@ -67,6 +116,9 @@ LevelSet::LevelSet(LevelSet&& other)
     , mRedistance(std::move(other.mRedistance))
     , mRedistanceFront(std::move(other.mRedistanceFront))
     , mRedistanceBack(std::move(other.mRedistanceBack))
+    , mRedistanceTiled(std::move(other.mRedistanceTiled))
+    , mRedistanceTiledFront(std::move(other.mRedistanceTiledFront))
+    , mRedistanceTiledBack(std::move(other.mRedistanceTiledBack))
     , mExtrapolateCmd(std::move(other.mExtrapolateCmd))
     , mReinitialiseCmd(std::move(other.mReinitialiseCmd))
 {
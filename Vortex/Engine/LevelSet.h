@@ -57,6 +57,9 @@ private:
   Renderer::Work mRedistance;
   Renderer::Work::Bound mRedistanceFront;
   Renderer::Work::Bound mRedistanceBack;
+  Renderer::Work mRedistanceTiled;
+  Renderer::Work::Bound mRedistanceTiledFront;
+  Renderer::Work::Bound mRedistanceTiledBack;
 
   Renderer::CommandBuffer mExtrapolateCmd;
   Renderer::CommandBuffer mReinitialiseCmd;
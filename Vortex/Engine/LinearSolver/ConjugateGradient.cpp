@@ -18,38 +18,41 @@ ConjugateGradient::ConjugateGradient(Renderer::Device& device,
                                      Preconditioner& preconditioner)
     : mDevice(device)
     , mPreconditioner(preconditioner)
+    , mRefinementSteps(0)
     , r(device, size.x * size.y)
     , s(device, size.x * size.y)
     , z(device, size.x * size.y)
-    , inner(device, size.x * size.y)
     , alpha(device, 1)
     , beta(device, 1)
     , rho(device, 1)
     , rho_new(device, 1)
     , sigma(device, 1)
+    , one(device, 1)
     , error(device)
     , localError(device, 1, Renderer::MemoryUsage::GpuToCpu)
     , matrixMultiply(device, Renderer::ComputeSize{size}, SPIRV::MultiplyMatrix_comp)
     , scalarDivision(device, Renderer::ComputeSize{glm::ivec2(1)}, SPIRV::Divide_comp)
-    , scalarMultiply(device, Renderer::ComputeSize{size}, SPIRV::Multiply_comp)
     , multiplyAdd(device, Renderer::ComputeSize{size}, SPIRV::MultiplyAdd_comp)
     , multiplySub(device, Renderer::ComputeSize{size}, SPIRV::MultiplySub_comp)
-    , reduceSum(device, size.x * size.y)
+    , reduceDot(device, size.x * size.y)
     , reduceMax(device, size.x * size.y)
     , reduceMaxBound(reduceMax.Bind(r, error))
-    , reduceSumRhoBound(reduceSum.Bind(inner, rho))
-    , reduceSumSigmaBound(reduceSum.Bind(inner, sigma))
-    , reduceSumRhoNewBound(reduceSum.Bind(inner, rho_new))
-    , multiplySBound(scalarMultiply.Bind({z, s, inner}))
-    , multiplyZBound(scalarMultiply.Bind({z, r, inner}))
+    , reduceDotRhoBound(reduceDot.Bind(z, r, rho))
+    , reduceDotSigmaBound(reduceDot.Bind(z, s, sigma))
+    , reduceDotRhoNewBound(reduceDot.Bind(z, r, rho_new))
     , divideRhoBound(scalarDivision.Bind({rho, sigma, alpha}))
     , divideRhoNewBound(scalarDivision.Bind({rho_new, rho, beta}))
     , multiplySubRBound(multiplySub.Bind({r, z, alpha, r}))
     , multiplyAddZBound(multiplyAdd.Bind({z, s, beta, s}))
     , mSolveInit(device, false)
     , mSolve(device, false)
+    , mSolveRestart(device, false)
     , mErrorRead(device)
 {
+  Renderer::Buffer<float> localOne(device, 1, Renderer::MemoryUsage::Cpu);
+  Renderer::CopyFrom(localOne, 1.0f);
+  device.Execute([&](Renderer::CommandEncoder& command) { one.CopyFrom(command, localOne); });
+
   mErrorRead.Record([&](Renderer::CommandEncoder& command)
                     { localError.CopyFrom(command, error); });
 }
@@ -64,7 +67,9 @@ void ConjugateGradient::Bind(Renderer::GenericBuffer& d,
   mPreconditioner.Bind(d, l, r, z);
 
   matrixMultiplyBound = matrixMultiply.Bind({d, l, s, z});
+  matrixMultiplyPBound = matrixMultiply.Bind({d, l, pressure, z});
   multiplyAddPBound = multiplyAdd.Bind({pressure, s, alpha, pressure});
+  residualBound = multiplySub.Bind({b, z, one, r});
 
   mSolveInit.Record(
       [&](Renderer::CommandEncoder& command)
@@ -89,9 +94,7 @@ void ConjugateGradient::Bind(Renderer::GenericBuffer& d,
         s.CopyFrom(command, z);
 
         // rho = zTr
-        multiplyZBound.Record(command);
-        inner.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
-        reduceSumRhoBound.Record(command);
+        reduceDotRhoBound.Record(command);
         z.Clear(command);
 
         command.DebugMarkerEnd();
@@ -107,9 +110,7 @@ void ConjugateGradient::Bind(Renderer::GenericBuffer& d,
         z.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
 
         // sigma = zTs
-        multiplySBound.Record(command);
-        inner.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
-        reduceSumSigmaBound.Record(command);
+        reduceDotSigmaBound.Record(command);
 
         // alpha = rho / sigma
         divideRhoBound.Record(command);
@@ -132,9 +133,7 @@ void ConjugateGradient::Bind(Renderer::GenericBuffer& d,
         z.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
 
         // rho_new = zTr
-        multiplyZBound.Record(command);
-        inner.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
-        reduceSumRhoNewBound.Record(command);
+        reduceDotRhoNewBound.Record(command);
 
         // beta = rho_new / rho
         divideRhoNewBound.Record(command);
@@ -148,6 +147,36 @@ void ConjugateGradient::Bind(Renderer::GenericBuffer& d,
         // rho = rho_new
         rho.CopyFrom(command, rho_new);
 
+        command.DebugMarkerEnd();
+      });
+
+  mSolveRestart.Record(
+      [&](Renderer::CommandEncoder& command)
+      {
+        command.DebugMarkerBegin("PCG Restart", {0.63f, 0.04f, 0.66f, 1.0f});
+
+        // r = b - Ap
+        z.Clear(command);
+        matrixMultiplyPBound.Record(command);
+        z.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+        residualBound.Record(command);
+        r.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+
+        // calculate error
+        reduceMaxBound.Record(command);
+
+        // z = M^-1 r
+        z.Clear(command);
+        mPreconditioner.Record(command);
+        z.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+
+        // s = z
+        s.CopyFrom(command, z);
+
+        // rho = zTr
+        reduceDotRhoBound.Record(command);
+        z.Clear(command);
+
         command.DebugMarkerEnd();
       });
 }
@@ -177,6 +206,7 @@ void ConjugateGradient::Solve(Parameters& params, const std::vector<RigidBody*>&
   }
 
   auto initialError = params.OutError;
+  int refinementSteps = rigidbodies.empty() ? mRefinementSteps : 0;
   for (unsigned i = 0; !params.IsFinished(initialError); params.OutIterations = ++i)
   {
     for (auto& rigidbody : rigidbodies)
@@ -190,6 +220,21 @@ void ConjugateGradient::Solve(Parameters& params, const std::vector<RigidBody*>&
     {
       mErrorRead.Wait();
       Renderer::CopyTo(localError, params.OutError);
+
+      // converged on the updated residual, check against the true residual.
+      // Stopping on the iteration count doesn't restart.
+      bool converged = params.Iterations > 0
+                           ? params.OutError <= params.ErrorTolerance * initialError
+                           : params.OutError <= params.ErrorTolerance;
+      bool iterationsLeft = params.Iterations == 0 || i + 1 < params.Iterations;
+      if (refinementSteps > 0 && converged && iterationsLeft)
+      {
+        refinementSteps--;
+        mSolveRestart.Submit();
+        mErrorRead.Submit().Wait();
+        Renderer::CopyTo(localError, params.OutError);
+      }
+
       mErrorRead.Submit();
     }
   }
@@ -200,6 +245,11 @@ void ConjugateGradient::Solve(Parameters& params, const std::vector<RigidBody*>&
   }
 }
 
+void ConjugateGradient::SetRefinementSteps(int steps)
+{
+  mRefinementSteps = steps;
+}
+
 float ConjugateGradient::GetError()
 {
   mErrorRead.Submit().Wait();
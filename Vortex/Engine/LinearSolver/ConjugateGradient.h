@@ -51,25 +51,37 @@ public:
 
   VORTEX_API float GetError() override;
 
+  /**
+   * @brief Set the number of iterative refinement steps. With an iterative
+   * solver, when the error has converged the residual is recomputed from the
+   * pressure (r = b - Ap) and the iterations restart from it, until the
+   * error of this residual converges too. This corrects the drift of the
+   * updated residual, e.g. with a reduced precision preconditioner, and is
+   * useful for tight tolerances. Not used with rigidbodies.
+   * @param steps maximum number of restarts, 0 by default
+   */
+  VORTEX_API void SetRefinementSteps(int steps);
+
 private:
   Renderer::Device& mDevice;
   Preconditioner& mPreconditioner;
+  int mRefinementSteps;
 
-  Renderer::Buffer<float> r, s, z, inner, alpha, beta, rho, rho_new, sigma;
+  Renderer::Buffer<float> r, s, z, alpha, beta, rho, rho_new, sigma, one;
   Renderer::Buffer<float> error, localError;
-  Renderer::Work matrixMultiply, scalarDivision, scalarMultiply, multiplyAdd, multiplySub;
-  ReduceSum reduceSum;
+  Renderer::Work matrixMultiply, scalarDivision, multiplyAdd, multiplySub;
+  ReduceDot reduceDot;
   ReduceMax reduceMax;
 
   ReduceMax::Bound reduceMaxBound;
-  ReduceSum::Bound reduceSumRhoBound, reduceSumSigmaBound, reduceSumRhoNewBound;
-  Renderer::Work::Bound multiplySBound, multiplyZBound;
-  Renderer::Work::Bound matrixMultiplyBound;
+  ReduceDot::Bound reduceDotRhoBound, reduceDotSigmaBound, reduceDotRhoNewBound;
+  Renderer::Work::Bound matrixMultiplyBound, matrixMultiplyPBound;
   Renderer::Work::Bound divideRhoBound;
   Renderer::Work::Bound divideRhoNewBound;
   Renderer::Work::Bound multiplyAddPBound, multiplySubRBound, multiplyAddZBound;
+  Renderer::Work::Bound residualBound;
 
-  Renderer::CommandBuffer mSolveInit, mSolve;
+  Renderer::CommandBuffer mSolveInit, mSolve, mSolveRestart;
   Renderer::CommandBuffer mErrorRead;
 };
 
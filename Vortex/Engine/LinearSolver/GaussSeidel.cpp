@@ -13,14 +13,53 @@ namespace Vortex
 {
 namespace Fluid
 {
-GaussSeidel::GaussSeidel(Renderer::Device& device, const glm::ivec2& size)
+namespace
+{
+// number of iterations done in one dispatch of the tiled version
+const int tiledIterations = 2;
+
+Renderer::ComputeSize MakeTiledComputeSize(const glm::ivec2& size, int iterations)
+{
+  // same as in GaussSeidelTiled.comp
+  glm::ivec2 localSize(16);
+  glm::ivec2 tileSize = 2 * localSize - glm::ivec2(4 * iterations);
+
+  Renderer::ComputeSize computeSize(size);
+  computeSize.LocalSize = localSize;
+  computeSize.WorkSize = Renderer::ComputeSize::GetWorkSize(size, tileSize);
+
+  return computeSize;
+}
+}  // namespace
+
+GaussSeidel::GaussSeidel(Renderer::Device& device, const glm::ivec2& size, Precision precision)
     : mW(2.0f / (1.0f + std::sin(glm::pi<float>() / std::sqrt((float)(size.x * size.y)))))
     , mPreconditionerIterations(1)
+    , mPrecision(precision)
     , mError(device, size)
-    , mGaussSeidel(device, Renderer::MakeCheckerboardComputeSize(size), SPIRV::GaussSeidel_comp)
+    , mGaussSeidel(device,
+                   Renderer::MakeCheckerboardComputeSize(size),
+                   precision == Precision::Half ? SPIRV::GaussSeidelHalf_comp
+                                                : SPIRV::GaussSeidel_comp)
+    , mTiledPressure(device, GetElementCount(size.x * size.y, precision))
+    , mGaussSeidelTiled(device,
+                        MakeTiledComputeSize(size, tiledIterations),
+                        precision == Precision::Half ? SPIRV::GaussSeidelTiledHalf_comp
+                                                     : SPIRV::GaussSeidelTiled_comp,
+                        Renderer::SpecConst(Renderer::SpecConstValue(3, tiledIterations)))
+    , mGaussSeidelTiledSingle(device,
+                              MakeTiledComputeSize(size, 1),
+                              precision == Precision::Half ? SPIRV::GaussSeidelTiledHalf_comp
+                                                           : SPIRV::GaussSeidelTiled_comp,
+                              Renderer::SpecConst(Renderer::SpecConstValue(3, 1)))
     , mInitCmd(device, false)
     , mGaussSeidelCmd(device, false)
 {
+  // the two cells packed in an element need to have different colours
+  if (precision == Precision::Half && size.x % 2 != 0)
+  {
+    throw std::runtime_error("Half precision gauss-seidel requires an even width");
+  }
 }
 
 GaussSeidel::~GaussSeidel() {}
@@ -42,8 +81,19 @@ void GaussSeidel::Bind(Renderer::GenericBuffer& d,
 {
   mPressure = &pressure;
 
-  mError.Bind(d, l, div, pressure);
+  // the error is computed with single precision kernels
+  if (mPrecision == Precision::Single)
+  {
+    mError.Bind(d, l, div, pressure);
+  }
+
   mGaussSeidelBound = mGaussSeidel.Bind({pressure, d, l, div});
+  mGaussSeidelTiledBound = mGaussSeidelTiled.Bind({pressure, d, l, div, mTiledPressure});
+  mGaussSeidelTiledBackBound = mGaussSeidelTiled.Bind({mTiledPressure, d, l, div, pressure});
+  mGaussSeidelTiledSingleBound =
+      mGaussSeidelTiledSingle.Bind({pressure, d, l, div, mTiledPressure});
+  mGaussSeidelTiledSingleBackBound =
+      mGaussSeidelTiledSingle.Bind({mTiledPressure, d, l, div, pressure});
 
   mInitCmd.Record([&](Renderer::CommandEncoder& command) { pressure.Clear(command); });
   mGaussSeidelCmd.Record([&](Renderer::CommandEncoder& command) { Record(command, 1); });
@@ -57,6 +107,11 @@ void GaussSeidel::BindRigidbody(float /*delta*/,
 
 void GaussSeidel::Solve(Parameters& params, const std::vector<RigidBody*>& /*rigidbodies*/)
 {
+  if (mPrecision == Precision::Half)
+  {
+    throw std::runtime_error("Gauss-Seidel solve not supported in half precision");
+  }
+
   params.Reset();
 
   mInitCmd.Submit();
@@ -92,6 +147,11 @@ void GaussSeidel::Solve(Parameters& params, const std::vector<RigidBody*>& /*rig
 
 float GaussSeidel::GetError()
 {
+  if (mPrecision == Precision::Half)
+  {
+    throw std::runtime_error("Gauss-Seidel error not supported in half precision");
+  }
+
   return mError.Submit().Wait().GetError();
 }
 
@@ -105,7 +165,37 @@ void GaussSeidel::Record(Renderer::CommandEncoder& command, int iterations)
 {
   mPressure->Barrier(command, Renderer::Access::Write, Renderer::Access::Write);
 
-  for (int i = 0; i < iterations; ++i)
+  // ping-pong between the pressure and a temporary buffer, as tiles read the
+  // halo written by other tiles. With an odd number of dispatches, the last
+  // one is split in two dispatches of one iteration, so the last dispatch
+  // writes to the pressure.
+  int tiledCount = iterations / tiledIterations;
+  for (int i = 0; i < tiledCount; ++i)
+  {
+    if (i % 2 == 0 && i == tiledCount - 1)
+    {
+      mGaussSeidelTiledSingleBound.PushConstant(command, mW);
+      mGaussSeidelTiledSingleBound.Record(command);
+      mTiledPressure.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+      mGaussSeidelTiledSingleBackBound.PushConstant(command, mW);
+      mGaussSeidelTiledSingleBackBound.Record(command);
+      mPressure->Barrier(command, Renderer::Access::Write, Renderer::Access::Write);
+    }
+    else if (i % 2 == 0)
+    {
+      mGaussSeidelTiledBound.PushConstant(command, mW);
+      mGaussSeidelTiledBound.Record(command);
+      mTiledPressure.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+    }
+    else
+    {
+      mGaussSeidelTiledBackBound.PushConstant(command, mW);
+      mGaussSeidelTiledBackBound.Record(command);
+      mPressure->Barrier(command, Renderer::Access::Write, Renderer::Access::Write);
+    }
+  }
+
+  for (int i = tiledCount * tiledIterations; i < iterations; ++i)
   {
     mGaussSeidelBound.PushConstant(command, mW, 1);
     mGaussSeidelBound.Record(command);
@@ -125,8 +215,14 @@ Renderer::ComputeSize MakeLocalSize(const glm::ivec2& size)
   return computeSize;
 }
 
-LocalGaussSeidel::LocalGaussSeidel(Renderer::Device& device, const glm::ivec2& size)
-    : mLocalGaussSeidel(device, MakeLocalSize(size), SPIRV::LocalGaussSeidel_comp)
+LocalGaussSeidel::LocalGaussSeidel(Renderer::Device& device,
+                                   const glm::ivec2& size,
+                                   LinearSolver::Precision precision)
+    : mLocalGaussSeidel(device,
+                        MakeLocalSize(size),
+                        precision == LinearSolver::Precision::Half
+                            ? SPIRV::LocalGaussSeidelHalf_comp
+                            : SPIRV::LocalGaussSeidel_comp)
 {
   // TODO check size is within local size
 }
@@ -21,7 +21,17 @@ namespace Fluid
 class GaussSeidel : public LinearSolver, public Preconditioner
 {
 public:
-  VORTEX_API GaussSeidel(Renderer::Device& device, const glm::ivec2& size);
+  /**
+   * @brief Initialize the gauss seidel solver
+   * @param device vulkan device
+   * @param size of the linear equations
+   * @param precision storage of the bound buffers, the error can only be
+   * computed, and the iterative solve used, in single precision. Half precision
+   * requires an even width.
+   */
+  VORTEX_API GaussSeidel(Renderer::Device& device,
+                         const glm::ivec2& size,
+                         Precision precision = Precision::Single);
   VORTEX_API ~GaussSeidel() override;
 
   VORTEX_API void Bind(Renderer::GenericBuffer& d,
@@ -44,7 +54,8 @@ public:
   void Record(Renderer::CommandEncoder& commandEncoder) override;
 
   /**
-   * @brief Record a determined number of iterations
+   * @brief Record a determined number of iterations. Pairs of iterations are
+   * done in one dispatch on tiles in shared memory.
    * @param commandBuffer
    * @param iterations
    */
@@ -66,12 +77,19 @@ public:
 private:
   float mW;
   int mPreconditionerIterations;
+  Precision mPrecision;
 
   LinearSolver::Error mError;
 
   Renderer::Work mGaussSeidel;
   Renderer::Work::Bound mGaussSeidelBound;
 
+  Renderer::Buffer<float> mTiledPressure;
+  Renderer::Work mGaussSeidelTiled;
+  Renderer::Work::Bound mGaussSeidelTiledBound, mGaussSeidelTiledBackBound;
+  Renderer::Work mGaussSeidelTiledSingle;
+  Renderer::Work::Bound mGaussSeidelTiledSingleBound, mGaussSeidelTiledSingleBackBound;
+
   Renderer::CommandBuffer mInitCmd;
   Renderer::CommandBuffer mGaussSeidelCmd;
   Renderer::GenericBuffer* mPressure;
@@ -84,7 +102,16 @@ private:
 class LocalGaussSeidel : public Preconditioner
 {
 public:
-  VORTEX_API LocalGaussSeidel(Renderer::Device& device, const glm::ivec2& size);
+  /**
+   * @brief Initialize the local gauss seidel solver
+   * @param device vulkan device
+   * @param size of the linear equations
+   * @param precision storage of the bound buffers
+   */
+  VORTEX_API LocalGaussSeidel(
+      Renderer::Device& device,
+      const glm::ivec2& size,
+      LinearSolver::Precision precision = LinearSolver::Precision::Single);
   VORTEX_API ~LocalGaussSeidel() override;
 
   void VORTEX_API Bind(Renderer::GenericBuffer& d,
@@ -13,11 +13,16 @@ namespace Vortex
 {
 namespace Fluid
 {
-Jacobi::Jacobi(Renderer::Device& device, const glm::ivec2& size)
+Jacobi::Jacobi(Renderer::Device& device,
+               const glm::ivec2& size,
+               LinearSolver::Precision precision)
     : mW(1.0f)
     , mPreconditionerIterations(1)
-    , mBackPressure(device, size.x * size.y)
-    , mJacobi(device, Renderer::ComputeSize{size}, SPIRV::DampedJacobi_comp)
+    , mBackPressure(device, LinearSolver::GetElementCount(size.x * size.y, precision))
+    , mJacobi(device,
+              LinearSolver::MakeComputeSize(size, precision),
+              precision == LinearSolver::Precision::Half ? SPIRV::DampedJacobiHalf_comp
+                                                         : SPIRV::DampedJacobi_comp)
 {
 }
 
@@ -22,7 +22,15 @@ namespace Fluid
 class Jacobi : public Preconditioner
 {
 public:
-  Jacobi(Renderer::Device& device, const glm::ivec2& size);
+  /**
+   * @brief Initialize the jacobi solver
+   * @param device vulkan device
+   * @param size of the linear equations
+   * @param precision storage of the bound buffers
+   */
+  Jacobi(Renderer::Device& device,
+         const glm::ivec2& size,
+         LinearSolver::Precision precision = LinearSolver::Precision::Single);
 
   void Bind(Renderer::GenericBuffer& d,
             Renderer::GenericBuffer& l,
@@ -21,13 +21,26 @@ LinearSolver::Parameters::Parameters(SolverType type, unsigned iterations, float
 {
 }
 
+Renderer::ComputeSize LinearSolver::MakeComputeSize(const glm::ivec2& size, Precision precision)
+{
+  // same as first_cell in Half.comp
+  int cells = precision == Precision::Half ? 2 : 1;
+
+  Renderer::ComputeSize computeSize(size);
+  computeSize.WorkSize = Renderer::ComputeSize::GetWorkSize(
+      glm::ivec2((size.x + cells - 1) / cells, size.y), computeSize.LocalSize);
+
+  return computeSize;
+}
+
 LinearSolver::Data::Data(Renderer::Device& device,
                          const glm::ivec2& size,
-                         Renderer::MemoryUsage memoryUsage)
-    : Diagonal(device, size.x * size.y, memoryUsage)
-    , Lower(device, size.x * size.y, memoryUsage)
-    , B(device, size.x * size.y, memoryUsage)
-    , X(device, size.x * size.y, memoryUsage)
+                         Renderer::MemoryUsage memoryUsage,
+                         Precision precision)
+    : Diagonal(device, GetElementCount(size.x * size.y, precision), memoryUsage)
+    , Lower(device, (GetElementCount(2 * size.x * size.y, precision) + 1) / 2, memoryUsage)
+    , B(device, GetElementCount(size.x * size.y, precision), memoryUsage)
+    , X(device, GetElementCount(size.x * size.y, precision), memoryUsage)
 {
   device.Execute(
       [&](Renderer::CommandEncoder& command)
@@ -65,6 +65,39 @@ struct LinearSolver
     float OutError;
   };
 
+  /**
+   * @brief Storage of the linear equations. In half precision, two scalars or
+   * one vec2 are packed in each 32 bit element of the buffers, which limits
+   * the values to the half float range (65504).
+   */
+  enum class Precision
+  {
+    Single,
+    Half,
+  };
+
+  /**
+   * @brief Number of 32 bit elements needed to store a number of scalars.
+   * @param count number of scalars
+   * @param precision storage precision
+   * @return the number of elements
+   */
+  static int GetElementCount(int count, Precision precision)
+  {
+    return precision == Precision::Half ? (count + 1) / 2 : count;
+  }
+
+  /**
+   * @brief Compute size of a kernel writing a grid stored with a precision. In
+   * half precision, each invocation computes the two scalars of an element and
+   * writes it once, so there are half as many invocations in x.
+   * @param size size of the grid
+   * @param precision storage precision of the grid written
+   * @return the compute size, with the grid size as domain size
+   */
+  VORTEX_API static Renderer::ComputeSize MakeComputeSize(const glm::ivec2& size,
+                                                          Precision precision);
+
   /**
    * @brief The various parts of linear equations.
    */
@@ -72,7 +105,8 @@ struct LinearSolver
   {
     VORTEX_API Data(Renderer::Device& device,
                     const glm::ivec2& size,
-                    Renderer::MemoryUsage memoryUsage = Renderer::MemoryUsage::Gpu);
+                    Renderer::MemoryUsage memoryUsage = Renderer::MemoryUsage::Gpu,
+                    Precision precision = Precision::Single);
 
     Renderer::Buffer<float> Diagonal;
     Renderer::Buffer<glm::vec2> Lower;
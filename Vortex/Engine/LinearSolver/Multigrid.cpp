@@ -43,11 +43,12 @@ glm::ivec2 Depth::GetDepthSize(std::size_t i) const
 std::unique_ptr<Preconditioner> MakeSmoother(Renderer::Device& device,
                                              glm::ivec2 size,
                                              Multigrid::SmootherSolver smoother,
-                                             int numSmoothingIterations)
+                                             int numSmoothingIterations,
+                                             LinearSolver::Precision precision)
 {
   if (smoother == Multigrid::SmootherSolver::Jacobi)
   {
-    auto solver = std::make_unique<Jacobi>(device, size);
+    auto solver = std::make_unique<Jacobi>(device, size, precision);
     solver->SetPreconditionerIterations(numSmoothingIterations);
     solver->SetW(2.0f / 3.0f);
 
@@ -55,7 +56,7 @@ std::unique_ptr<Preconditioner> MakeSmoother(Renderer::Device& device,
   }
   else if (smoother == Multigrid::SmootherSolver::GaussSeidel)
   {
-    auto solver = std::make_unique<GaussSeidel>(device, size);
+    auto solver = std::make_unique<GaussSeidel>(device, size, precision);
     solver->SetPreconditionerIterations(numSmoothingIterations);
     solver->SetW(2.0f / 3.0f);
 
@@ -69,15 +70,22 @@ Multigrid::Multigrid(Renderer::Device& device,
                      const glm::ivec2& size,
                      float delta,
                      int numSmoothingIterations,
-                     SmootherSolver smoother)
+                     SmootherSolver smoother,
+                     Precision precision)
     : mDevice(device)
     , mDepth(size)
     , mDelta(delta)
     , mNumSmoothingIterations(numSmoothingIterations)
+    , mPrecision(precision)
     , mResidualWork(device, Renderer::ComputeSize{size}, SPIRV::Residual_comp)
+    , mCoarseResidualWork(device,
+                          Renderer::ComputeSize{size},
+                          precision == Precision::Half ? SPIRV::ResidualHalf_comp
+                                                       : SPIRV::Residual_comp)
     , mTransfer(device)
+    , mResidualMemory(device)
     , mPhiScaleWork(device, Renderer::ComputeSize{size}, SPIRV::PhiScale_comp)
-    , mSmoother(device, mDepth.GetDepthSize(mDepth.GetMaxDepth()))
+    , mSmoother(device, mDepth.GetDepthSize(mDepth.GetMaxDepth()), precision)
     , mBuildHierarchies(device, false)
     , mFullCycleSolver(device, false)
     , mVCycleSolver(device, false)
@@ -86,7 +94,7 @@ Multigrid::Multigrid(Renderer::Device& device,
   for (int i = 1; i <= mDepth.GetMaxDepth(); i++)
   {
     auto s = mDepth.GetDepthSize(i);
-    mDatas.emplace_back(device, s);
+    mDatas.emplace_back(device, s, Renderer::MemoryUsage::Gpu, precision);
 
     mSolidPhis.emplace_back(device, s);
     mLiquidPhis.emplace_back(device, s);
@@ -95,10 +103,15 @@ Multigrid::Multigrid(Renderer::Device& device,
   for (int i = 0; i < mDepth.GetMaxDepth(); i++)
   {
     auto s = mDepth.GetDepthSize(i);
-    mResiduals.emplace_back(device, s.x * s.y);
-    mSmoothers.emplace_back(MakeSmoother(device, s, smoother, numSmoothingIterations));
+    // level 0 is bound to the buffers of the linear equations, in single precision
+    auto levelPrecision = i == 0 ? Precision::Single : precision;
+    mResiduals.emplace_back(device, GetElementCount(s.x * s.y, levelPrecision), mResidualMemory);
+    mSmoothers.emplace_back(
+        MakeSmoother(device, s, smoother, numSmoothingIterations, levelPrecision));
   }
 
+  mResidualMemory.Allocate();
+
   int depth = mDepth.GetMaxDepth() - 1;
   mSmoother.Bind(mDatas[depth].Diagonal, mDatas[depth].Lower, mDatas[depth].B, mDatas[depth].X);
   mResidualWorkBound.resize(mDepth.GetMaxDepth() + 1);
@@ -118,8 +131,10 @@ void Multigrid::Bind(Renderer::GenericBuffer& d,
   mSmoothers[0]->Bind(d, l, b, pressure);
 
   auto s = mDepth.GetDepthSize(0);
-  mTransfer.RestrictBind(0, s, mResiduals[0], d, mDatas[0].B, mDatas[0].Diagonal);
-  mTransfer.ProlongateBind(0, s, pressure, d, mDatas[0].X, mDatas[0].Diagonal);
+  mTransfer.RestrictBind(
+      0, s, mResiduals[0], d, mDatas[0].B, mDatas[0].Diagonal, Precision::Single, mPrecision);
+  mTransfer.ProlongateBind(
+      0, s, pressure, d, mDatas[0].X, mDatas[0].Diagonal, Precision::Single, mPrecision);
 
   mFullCycleSolver.Record(
       [&](Renderer::CommandEncoder& command)
@@ -195,26 +210,30 @@ void Multigrid::RecursiveBind(Pressure& pressure, std::size_t depth)
     mSolidPhiScaleWorkBound.push_back(
         mPhiScaleWork.Bind(Renderer::ComputeSize{s1}, {mSolidPhis[depth - 1], mSolidPhis[depth]}));
 
-    mResidualWorkBound[depth] = mResidualWork.Bind(Renderer::ComputeSize{s0},
-                                                   {mDatas[depth - 1].X,
-                                                    mDatas[depth - 1].Diagonal,
-                                                    mDatas[depth - 1].Lower,
-                                                    mDatas[depth - 1].B,
-                                                    mResiduals[depth]});
+    mResidualWorkBound[depth] = mCoarseResidualWork.Bind(MakeComputeSize(s0, mPrecision),
+                                                         {mDatas[depth - 1].X,
+                                                          mDatas[depth - 1].Diagonal,
+                                                          mDatas[depth - 1].Lower,
+                                                          mDatas[depth - 1].B,
+                                                          mResiduals[depth]});
 
     mTransfer.RestrictBind(depth,
                            s0,
                            mResiduals[depth],
                            mDatas[depth - 1].Diagonal,
                            mDatas[depth].B,
-                           mDatas[depth].Diagonal);
+                           mDatas[depth].Diagonal,
+                           mPrecision,
+                           mPrecision);
 
     mTransfer.ProlongateBind(depth,
                              s0,
                              mDatas[depth - 1].X,
                              mDatas[depth - 1].Diagonal,
                              mDatas[depth].X,
-                             mDatas[depth].Diagonal);
+                             mDatas[depth].Diagonal,
+                             mPrecision,
+                             mPrecision);
 
     mSmoothers[depth]->Bind(mDatas[depth - 1].Diagonal,
                             mDatas[depth - 1].Lower,
@@ -228,7 +247,8 @@ void Multigrid::RecursiveBind(Pressure& pressure, std::size_t depth)
                                                        mDatas[depth - 1].Diagonal,
                                                        mDatas[depth - 1].Lower,
                                                        mLiquidPhis[depth - 1],
-                                                       mSolidPhis[depth - 1]));
+                                                       mSolidPhis[depth - 1],
+                                                       mPrecision));
 }
 
 void Multigrid::BuildHierarchies()
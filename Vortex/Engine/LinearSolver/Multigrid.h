@@ -71,12 +71,18 @@ public:
    * @param device vulkan device
    * @param size of the linear equations
    * @param delta timestep delta
+   * @param numSmoothingIterations number of smoother iterations on each level
+   * @param smoother the smoother used on each level
+   * @param precision storage of the coarser levels. In half precision, the
+   * hierarchy uses half the memory and bandwidth, but is only accurate enough
+   * as a preconditioner, see ConjugateGradient::SetRefinementSteps.
    */
   VORTEX_API Multigrid(Renderer::Device& device,
                        const glm::ivec2& size,
                        float delta,
                        int numSmoothingIterations = 3,
-                       SmootherSolver smoother = SmootherSolver::Jacobi);
+                       SmootherSolver smoother = SmootherSolver::Jacobi,
+                       Precision precision = Precision::Single);
 
   VORTEX_API ~Multigrid() override;
 
@@ -130,8 +136,11 @@ private:
   Depth mDepth;
   float mDelta;
   int mNumSmoothingIterations;
+  Precision mPrecision;
 
+  // mResidualWork is used on level 0, mCoarseResidualWork on the other levels
   Renderer::Work mResidualWork;
+  Renderer::Work mCoarseResidualWork;
   std::vector<Renderer::Work::Bound> mResidualWorkBound;
 
   Transfer mTransfer;
@@ -141,7 +150,10 @@ private:
   // mDatas[0]  is level 1
   std::vector<LinearSolver::Data> mDatas;
 
-  // mResiduals[0] is level 0
+  // mResiduals[0] is level 0, all levels share the same memory as a residual
+  // is only used until it's restricted to the next level. The levels after 0
+  // have the precision of the hierarchy.
+  Renderer::TransientMemory mResidualMemory;
   std::vector<Renderer::Buffer<float>> mResiduals;
 
   Renderer::Work mPhiScaleWork;
@@ -29,50 +29,50 @@ Renderer::ComputeSize MakeComputeSize(int size)
 }
 }  // namespace
 
-Reduce::Reduce(Renderer::Device& device,
-               const Renderer::SpirvBinary& spirv,
-               int size,
-               std::size_t typeSize)
-    : mSize(size), mReduce(device, Renderer::ComputeSize::Default1D(), spirv)
+Reduce::Reduce(Renderer::Device& device, int size, ReduceOp op, std::size_t typeSize)
+    : mSize(size)
+    , mOp(op)
+    , mReduce(device,
+              Renderer::ComputeSize::Default1D(),
+              SPIRV::Reduce_comp,
+              Renderer::SpecConst(Renderer::SpecConstValue(3, static_cast<int>(op)),
+                                  Renderer::SpecConstValue(4, int(typeSize / sizeof(float)))))
+    , mPartials(device, MakeComputeSize(size).WorkSize.x)
+    , mCounter(device)
 {
-  auto computeSize = MakeComputeSize(mSize);
-  while (computeSize.WorkSize.x > 1)
+  if (typeSize % sizeof(float) != 0 || typeSize > 4 * sizeof(float))
   {
-    mBuffers.emplace_back(device,
-                          Renderer::BufferUsage::Storage,
-                          Renderer::MemoryUsage::Gpu,
-                          typeSize * computeSize.WorkSize.x);
-
-    computeSize = MakeComputeSize(computeSize.WorkSize.x);
+    throw std::runtime_error("Reduce type needs to be made of 1 to 4 floats");
   }
 
-  assert(computeSize.WorkSize.x == 1);
+  device.Execute([&](Renderer::CommandEncoder& command) { mCounter.Clear(command); });
 }
 
 Reduce::Bound Reduce::Bind(Renderer::GenericBuffer& input, Renderer::GenericBuffer& output)
 {
-  std::vector<Renderer::GenericBuffer*> buffers;
-  buffers.push_back(&input);
-  for (auto& buffer : mBuffers)
+  return Bind(input, input, output);
+}
+
+Reduce::Bound Reduce::Bind(Renderer::GenericBuffer& input1,
+                           Renderer::GenericBuffer& input2,
+                           Renderer::GenericBuffer& output)
+{
+  if (&input1 != &input2 && mOp != ReduceOp::Dot)
   {
-    buffers.push_back(&buffer);
+    throw std::runtime_error("Two inputs only supported with dot product");
   }
-  buffers.push_back(&output);
 
   std::vector<Renderer::CommandBuffer::CommandFn> bufferBarriers;
   std::vector<Renderer::Work::Bound> bounds;
 
-  auto computeSize = MakeComputeSize(mSize);
-  for (std::size_t i = 0; i < buffers.size() - 1; i++)
-  {
-    bounds.emplace_back(mReduce.Bind(computeSize, {*buffers[i], *buffers[i + 1]}));
-    computeSize = MakeComputeSize(computeSize.WorkSize.x);
-
-    auto* buffer = buffers[i + 1];
-    bufferBarriers.emplace_back(
-        [=](Renderer::CommandEncoder& command)
-        { buffer->Barrier(command, Renderer::Access::Write, Renderer::Access::Read); });
-  }
+  bounds.emplace_back(
+      mReduce.Bind(MakeComputeSize(mSize), {input1, output, mPartials, mCounter, input2}));
+  bufferBarriers.emplace_back(
+      [&](Renderer::CommandEncoder& command)
+      {
+        output.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+        mCounter.Barrier(command, Renderer::Access::Write, Renderer::Access::Write);
+      });
 
   return Bound(mSize, bufferBarriers, std::move(bounds));
 }
@@ -86,20 +86,15 @@ Reduce::Bound::Bound(int size,
 
 void Reduce::Bound::Record(Renderer::CommandEncoder& command)
 {
-  int localSize = 2 * Renderer::ComputeSize::GetLocalSize1D();
-  int workGroupSize = mSize;
-
   for (std::size_t i = 0; i < mBounds.size(); i++)
   {
     mBounds[i].Record(command);
     mBufferBarriers[i](command);
-
-    workGroupSize = (workGroupSize + localSize - 1) / localSize;
   }
 }
 
 ReduceSum::ReduceSum(Renderer::Device& device, int size)
-    : Reduce(device, SPIRV::Sum_comp, size, sizeof(float))
+    : Reduce(device, size, ReduceOp::Sum, sizeof(float))
 {
 }
 
@@ -111,12 +106,17 @@ struct J
 };
 
 ReduceJ::ReduceJ(Renderer::Device& device, int size)
-    : Reduce(device, SPIRV::SumJ_comp, size, sizeof(J))
+    : Reduce(device, size, ReduceOp::Sum, sizeof(J))
+{
+}
+
+ReduceDot::ReduceDot(Renderer::Device& device, int size)
+    : Reduce(device, size, ReduceOp::Dot, sizeof(float))
 {
 }
 
 ReduceMax::ReduceMax(Renderer::Device& device, int size)
-    : Reduce(device, SPIRV::Max_comp, size, sizeof(float))
+    : Reduce(device, size, ReduceOp::MaxAbs, sizeof(float))
 {
 }
 
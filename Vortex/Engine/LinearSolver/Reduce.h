@@ -13,8 +13,23 @@ namespace Vortex
 namespace Fluid
 {
 /**
- * @brief Parallel reduction of a buffer into one value. The operator and type
- * of data is specified by inheriting the class.
+ * @brief Operator used to reduce elements, applied independently on each
+ * float of an element.
+ */
+enum class ReduceOp : int
+{
+  Sum = 0,
+  MaxAbs = 1,
+  Min = 2,
+  Max = 3,
+  SumSquares = 4,
+  Dot = 5,
+};
+
+/**
+ * @brief Parallel reduction of a buffer into one value, done in a single
+ * dispatch. The operator and type of data is specified by inheriting the
+ * class, see @ref ReduceOperation.
  */
 class Reduce
 {
@@ -55,16 +70,54 @@ public:
    */
   VORTEX_API Reduce::Bound Bind(Renderer::GenericBuffer& input, Renderer::GenericBuffer& output);
 
+  /**
+   * @brief Bind the reduce operation with two inputs, only valid for the
+   * @ref ReduceOp::Dot operator.
+   * @param input1 first input buffer
+   * @param input2 second input buffer
+   * @param output output buffer
+   * @return a bound object that can be recorded in a command buffer.
+   */
+  VORTEX_API Reduce::Bound Bind(Renderer::GenericBuffer& input1,
+                                Renderer::GenericBuffer& input2,
+                                Renderer::GenericBuffer& output);
+
 protected:
-  Reduce(Renderer::Device& device,
-         const Renderer::SpirvBinary& spirv,
-         int size,
-         std::size_t typeSize);
+  /**
+   * @brief Initialize reduce
+   * @param device vulkan device
+   * @param size number of elements to reduce
+   * @param op the reduce operator
+   * @param typeSize size of an element, made of 1 to 4 floats
+   */
+  VORTEX_API Reduce(Renderer::Device& device, int size, ReduceOp op, std::size_t typeSize);
 
 private:
   int mSize;
+  ReduceOp mOp;
   Renderer::Work mReduce;
-  std::vector<Renderer::GenericBuffer> mBuffers;
+  Renderer::Buffer<glm::vec4> mPartials;
+  Renderer::Buffer<std::uint32_t> mCounter;
+};
+
+/**
+ * @brief Reduce operation of any type made of floats (e.g. float, glm::vec2)
+ * with a given operator.
+ */
+template <typename T, ReduceOp Op>
+class ReduceOperation : public Reduce
+{
+public:
+  /**
+   * @brief Initialize reduce with device and 2d size
+   * @param device
+   * @param size
+   */
+  ReduceOperation(Renderer::Device& device, int size) : Reduce(device, size, Op, sizeof(T))
+  {
+    static_assert(sizeof(T) % sizeof(float) == 0 && sizeof(T) <= 4 * sizeof(float),
+                  "Type needs to be made of 1 to 4 floats");
+  }
 };
 
 /**
@@ -96,6 +149,20 @@ public:
   VORTEX_API ReduceJ(Renderer::Device& device, int size);
 };
 
+/**
+ * @brief Dot product of two float buffers.
+ */
+class ReduceDot : public Reduce
+{
+public:
+  /**
+   * @brief Initialize reduce with device and 2d size
+   * @param device
+   * @param size
+   */
+  VORTEX_API ReduceDot(Renderer::Device& device, int size);
+};
+
 /**
  * @brief Reduce operation on float with max of absolute.
  */
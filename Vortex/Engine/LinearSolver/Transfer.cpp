@@ -11,10 +11,38 @@ namespace Vortex
 {
 namespace Fluid
 {
+namespace
+{
+Renderer::Work& SelectWork(LinearSolver::Precision finePrecision,
+                           LinearSolver::Precision coarsePrecision,
+                           Renderer::Work& singleWork,
+                           Renderer::Work& coarseHalfWork,
+                           Renderer::Work& halfWork)
+{
+  if (finePrecision == LinearSolver::Precision::Single)
+  {
+    return coarsePrecision == LinearSolver::Precision::Single ? singleWork : coarseHalfWork;
+  }
+
+  if (coarsePrecision == LinearSolver::Precision::Single)
+  {
+    throw std::runtime_error("Coarse level must be in half precision if fine level is");
+  }
+
+  return halfWork;
+}
+}  // namespace
+
 Transfer::Transfer(Renderer::Device& device)
     : mDevice(device)
     , mProlongateWork(device, Renderer::ComputeSize::Default2D(), SPIRV::Prolongate_comp)
+    , mProlongateFromHalfWork(device,
+                              Renderer::ComputeSize::Default2D(),
+                              SPIRV::ProlongateFromHalf_comp)
+    , mProlongateHalfWork(device, Renderer::ComputeSize::Default2D(), SPIRV::ProlongateHalf_comp)
     , mRestrictWork(device, Renderer::ComputeSize::Default2D(), SPIRV::Restrict_comp)
+    , mRestrictToHalfWork(device, Renderer::ComputeSize::Default2D(), SPIRV::RestrictToHalf_comp)
+    , mRestrictHalfWork(device, Renderer::ComputeSize::Default2D(), SPIRV::RestrictHalf_comp)
 {
 }
 
@@ -23,7 +51,9 @@ void Transfer::ProlongateBind(std::size_t level,
                               Renderer::GenericBuffer& fine,
                               Renderer::GenericBuffer& fineDiagonal,
                               Renderer::GenericBuffer& coarse,
-                              Renderer::GenericBuffer& coarseDiagonal)
+                              Renderer::GenericBuffer& coarseDiagonal,
+                              LinearSolver::Precision finePrecision,
+                              LinearSolver::Precision coarsePrecision)
 {
   if (mProlongateBound.size() < level + 1)
   {
@@ -31,8 +61,13 @@ void Transfer::ProlongateBind(std::size_t level,
     mProlongateBuffer.resize(level + 1);
   }
 
-  mProlongateBound[level] = mProlongateWork.Bind(Renderer::ComputeSize{fineSize},
-                                                 {fineDiagonal, fine, coarseDiagonal, coarse});
+  auto& work = SelectWork(finePrecision,
+                          coarsePrecision,
+                          mProlongateWork,
+                          mProlongateFromHalfWork,
+                          mProlongateHalfWork);
+  mProlongateBound[level] = work.Bind(LinearSolver::MakeComputeSize(fineSize, finePrecision),
+                                      {fineDiagonal, fine, coarseDiagonal, coarse});
   mProlongateBuffer[level] = &fine;
 }
 
@@ -41,7 +76,9 @@ void Transfer::RestrictBind(std::size_t level,
                             Renderer::GenericBuffer& fine,
                             Renderer::GenericBuffer& fineDiagonal,
                             Renderer::GenericBuffer& coarse,
-                            Renderer::GenericBuffer& coarseDiagonal)
+                            Renderer::GenericBuffer& coarseDiagonal,
+                            LinearSolver::Precision finePrecision,
+                            LinearSolver::Precision coarsePrecision)
 {
   if (mRestrictBound.size() < level + 1)
   {
@@ -51,8 +88,10 @@ void Transfer::RestrictBind(std::size_t level,
 
   glm::ivec2 coarseSize = fineSize / glm::ivec2(2);
 
-  mRestrictBound[level] = mRestrictWork.Bind(Renderer::ComputeSize{coarseSize},
-                                             {fineDiagonal, fine, coarseDiagonal, coarse});
+  auto& work = SelectWork(
+      finePrecision, coarsePrecision, mRestrictWork, mRestrictToHalfWork, mRestrictHalfWork);
+  mRestrictBound[level] = work.Bind(LinearSolver::MakeComputeSize(coarseSize, coarsePrecision),
+                                    {fineDiagonal, fine, coarseDiagonal, coarse});
   mRestrictBuffer[level] = &coarse;
 }
 
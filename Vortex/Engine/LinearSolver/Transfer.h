@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <Vortex/Engine/LinearSolver/LinearSolver.h>
 #include <Vortex/Renderer/CommandBuffer.h>
 #include <Vortex/Renderer/Work.h>
 
@@ -36,13 +37,18 @@ public:
    * @param coarse the coarse level set
    * @param coarseDiagonal the diagonal of the linear equation matrix at size
    * half of @p fineSize
+   * @param finePrecision storage of @p fine and @p fineDiagonal
+   * @param coarsePrecision storage of @p coarse and @p coarseDiagonal
    */
-  VORTEX_API void ProlongateBind(std::size_t level,
-                                 const glm::ivec2& fineSize,
-                                 Renderer::GenericBuffer& fine,
-                                 Renderer::GenericBuffer& fineDiagonal,
-                                 Renderer::GenericBuffer& coarse,
-                                 Renderer::GenericBuffer& coarseDiagonal);
+  VORTEX_API void ProlongateBind(
+      std::size_t level,
+      const glm::ivec2& fineSize,
+      Renderer::GenericBuffer& fine,
+      Renderer::GenericBuffer& fineDiagonal,
+      Renderer::GenericBuffer& coarse,
+      Renderer::GenericBuffer& coarseDiagonal,
+      LinearSolver::Precision finePrecision = LinearSolver::Precision::Single,
+      LinearSolver::Precision coarsePrecision = LinearSolver::Precision::Single);
 
   /**
    * @brief Restricing the level set on a coarser level set. Averages 4 cells
@@ -55,13 +61,18 @@ public:
    * @param coarse the coarse level set
    * @param coarseDiagonal the diagonal of the linear equation matrix at size
    * half of @p fineSize
+   * @param finePrecision storage of @p fine and @p fineDiagonal
+   * @param coarsePrecision storage of @p coarse and @p coarseDiagonal
    */
-  VORTEX_API void RestrictBind(std::size_t level,
-                               const glm::ivec2& fineSize,
-                               Renderer::GenericBuffer& fine,
-                               Renderer::GenericBuffer& fineDiagonal,
-                               Renderer::GenericBuffer& coarse,
-                               Renderer::GenericBuffer& coarseDiagonal);
+  VORTEX_API void RestrictBind(
+      std::size_t level,
+      const glm::ivec2& fineSize,
+      Renderer::GenericBuffer& fine,
+      Renderer::GenericBuffer& fineDiagonal,
+      Renderer::GenericBuffer& coarse,
+      Renderer::GenericBuffer& coarseDiagonal,
+      LinearSolver::Precision finePrecision = LinearSolver::Precision::Single,
+      LinearSolver::Precision coarsePrecision = LinearSolver::Precision::Single);
 
   /**
    * @brief Prolongate the level set, using the bound level sets at the
@@ -81,11 +92,12 @@ public:
 
 private:
   Renderer::Device& mDevice;
-  Renderer::Work mProlongateWork;
+  // single precision, coarser level in half precision, all in half precision
+  Renderer::Work mProlongateWork, mProlongateFromHalfWork, mProlongateHalfWork;
   std::vector<Renderer::Work::Bound> mProlongateBound;
   std::vector<Renderer::GenericBuffer*> mProlongateBuffer;
 
-  Renderer::Work mRestrictWork;
+  Renderer::Work mRestrictWork, mRestrictToHalfWork, mRestrictHalfWork;
   std::vector<Renderer::Work::Bound> mRestrictBound;
   std::vector<Renderer::GenericBuffer*> mRestrictBuffer;
 };
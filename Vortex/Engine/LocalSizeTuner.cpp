@@ -0,0 +1,170 @@
+//
+//  LocalSizeTuner.cpp
+//  Vortex
+//
+
+#include "LocalSizeTuner.h"
+
+#include <Vortex/Engine/Boundaries.h>
+#include <Vortex/Engine/World.h>
+#include <Vortex/Renderer/Shapes.h>
+#include <Vortex/Renderer/Timer.h>
+
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace Vortex
+{
+namespace Fluid
+{
+namespace
+{
+// x needs to be a multiple of 2 for the checkerboard kernels and y bigger than
+// the stencil diameter
+const glm::ivec2 localSizes2D[] = {{64, 4}, {32, 8}, {16, 16}, {32, 4}, {16, 8}, {8, 8}};
+const int localSizes1D[] = {256, 128, 64};
+
+const int timedSteps = 5;
+}  // namespace
+
+LocalSizeTuner::LocalSizeTuner(Renderer::Device& device, const std::string& filename)
+    : mDevice(device), mFilename(filename)
+{
+  Load();
+}
+
+void LocalSizeTuner::Tune(const glm::ivec2& size)
+{
+  auto name = mDevice.GetName();
+  auto it = mLocalSizes.find(name);
+  if (it == mLocalSizes.end())
+  {
+    LocalSizes best{Renderer::ComputeSize::GetLocalSize2D(),
+                    Renderer::ComputeSize::GetLocalSize1D()};
+
+    auto bestTime = std::numeric_limits<std::uint64_t>::max();
+    for (auto localSize : localSizes2D)
+    {
+      Renderer::ComputeSize::SetLocalSize2D(localSize);
+      auto time = Time(size);
+      if (time < bestTime)
+      {
+        bestTime = time;
+        best.LocalSize2D = localSize;
+      }
+    }
+
+    Renderer::ComputeSize::SetLocalSize2D(best.LocalSize2D);
+
+    bestTime = std::numeric_limits<std::uint64_t>::max();
+    for (auto localSize : localSizes1D)
+    {
+      Renderer::ComputeSize::SetLocalSize1D(localSize);
+      auto time = Time(size);
+      if (time < bestTime)
+      {
+        bestTime = time;
+        best.LocalSize1D = localSize;
+      }
+    }
+
+    it = mLocalSizes.emplace(name, best).first;
+    Save();
+  }
+
+  Renderer::ComputeSize::SetLocalSize2D(it->second.LocalSize2D);
+  Renderer::ComputeSize::SetLocalSize1D(it->second.LocalSize1D);
+}
+
+std::uint64_t LocalSizeTuner::Time(const glm::ivec2& size)
+{
+  WaterWorld world(mDevice, size, 0.01f, 1, Velocity::InterpolationMode::Linear);
+
+  auto fluid = std::make_shared<Renderer::IntRectangle>(mDevice, glm::vec2(size) * 0.8f);
+  fluid->Position = glm::vec2(size) * 0.1f;
+  fluid->Colour = glm::vec4(4);
+
+  world.RecordParticleCount({fluid}).Submit().Wait();
+
+  auto area = std::make_shared<Rectangle>(mDevice, glm::vec2(size) - glm::vec2(4.0f), true);
+  area->Position = glm::vec2(2.0f);
+
+  world.RecordStaticSolidPhi({area}).Submit().Wait();
+
+  auto gravity = std::make_shared<Renderer::Rectangle>(mDevice, glm::vec2(size));
+  gravity->Colour = {0.0f, 0.1f, 0.0f, 0.0f};
+
+  auto velocity = world.RecordVelocity({gravity}, VelocityOp::Add);
+  auto params = FixedParams(8);
+
+  // first step compiles the pipelines
+  world.SubmitVelocity(velocity);
+  world.Step(params);
+  mDevice.WaitIdle();
+
+  if (mDevice.HasTimer())
+  {
+    Renderer::Timer timer(mDevice);
+    timer.Start();
+    for (int i = 0; i < timedSteps; i++)
+    {
+      world.SubmitVelocity(velocity);
+      world.Step(params);
+    }
+    timer.Stop();
+    timer.Wait();
+
+    return timer.GetElapsedNs();
+  }
+  else
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < timedSteps; i++)
+    {
+      world.SubmitVelocity(velocity);
+      world.Step(params);
+    }
+    mDevice.WaitIdle();
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  }
+}
+
+// Each line of the cache file is: x2d y2d x1d device name
+void LocalSizeTuner::Load()
+{
+  std::ifstream file(mFilename);
+  std::string line;
+  while (std::getline(file, line))
+  {
+    std::istringstream stream(line);
+    LocalSizes localSizes;
+    std::string name;
+    if (stream >> localSizes.LocalSize2D.x >> localSizes.LocalSize2D.y >>
+        localSizes.LocalSize1D >> std::ws && std::getline(stream, name))
+    {
+      mLocalSizes[name] = localSizes;
+    }
+  }
+}
+
+void LocalSizeTuner::Save()
+{
+  std::ofstream file(mFilename);
+  if (!file)
+  {
+    throw std::runtime_error("Cannot write local sizes to " + mFilename);
+  }
+
+  for (auto& localSizes : mLocalSizes)
+  {
+    file << localSizes.second.LocalSize2D.x << " " << localSizes.second.LocalSize2D.y << " "
+         << localSizes.second.LocalSize1D << " " << localSizes.first << std::endl;
+  }
+}
+
+}  // namespace Fluid
+}  // namespace Vortex
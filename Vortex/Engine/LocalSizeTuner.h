@@ -0,0 +1,61 @@
+//
+//  LocalSizeTuner.h
+//  Vortex
+//
+
+#pragma once
+
+#include <Vortex/Renderer/Device.h>
+#include <Vortex/Renderer/Work.h>
+
+#include <map>
+#include <string>
+
+namespace Vortex
+{
+namespace Fluid
+{
+/**
+ * @brief Finds the default local sizes of compute shaders which are the
+ * fastest on a device. A water simulation, which runs the main kernels
+ * (redistance, projection, linear solver, particle transfer and advection), is
+ * timed with different local sizes. The results are stored per device in a
+ * cache file, so the timing is only done once.
+ */
+class LocalSizeTuner
+{
+public:
+  /**
+   * @brief Initialize the tuner
+   * @param device vulkan device
+   * @param filename the cache file where the local sizes are stored
+   */
+  VORTEX_API LocalSizeTuner(Renderer::Device& device,
+                            const std::string& filename = "vortex2d_local_sizes.txt");
+
+  /**
+   * @brief Set the local sizes of @ref Renderer::ComputeSize from the cache
+   * file, or time the candidates if the device is not in the cache file. Needs
+   * to be called before creating any other object.
+   * @param size the size of the simulation used for the timing
+   */
+  VORTEX_API void Tune(const glm::ivec2& size = glm::ivec2(256));
+
+private:
+  struct LocalSizes
+  {
+    glm::ivec2 LocalSize2D;
+    int LocalSize1D;
+  };
+
+  std::uint64_t Time(const glm::ivec2& size);
+  void Load();
+  void Save();
+
+  Renderer::Device& mDevice;
+  std::string mFilename;
+  std::map<std::string, LocalSizes> mLocalSizes;
+};
+
+}  // namespace Fluid
+}  // namespace Vortex
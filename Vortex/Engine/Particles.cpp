@@ -7,13 +7,25 @@
 
 #include <Vortex/Engine/LevelSet.h>
 
-#include <random>
+#include <algorithm>
 #include "vortex_generated_spirv.h"
 
 namespace Vortex
 {
 namespace Fluid
 {
+namespace
+{
+// Cells are stored by tiles of 8x8 (see CommonParticles.comp), the buffers
+// indexed by cell are padded to a whole number of tiles.
+int CellCount(const glm::ivec2& size)
+{
+  const int tileSize = 8;
+  glm::ivec2 tiles = (size + glm::ivec2(tileSize - 1)) / tileSize;
+  return tiles.x * tiles.y * tileSize * tileSize;
+}
+}  // namespace
+
 float DefaultParticleSize()
 {
   return 1.0f / std::sqrt(2.0f);
@@ -25,32 +37,37 @@ ParticleCount::ParticleCount(Renderer::Device& device,
                              Velocity::InterpolationMode interpolationMode,
                              const Renderer::DispatchParams& params,
                              float alpha,
-                             float particleSize)
+                             float particleSize,
+                             int particlesPerCell)
     : Renderer::RenderTexture(device, size.x, size.y, Renderer::Format::R32Sint)
     , mDevice(device)
     , mSize(size)
+    , mParticlesPerCell(particlesPerCell)
     , mParticles(particles)
-    , mNewParticles(device, 8 * size.x * size.y)
-    , mDelta(device, size.x * size.y)
-    , mCount(device, size.x * size.y)
-    , mIndex(device, size.x * size.y)
-    , mSeeds(device, 4, Renderer::MemoryUsage::CpuToGpu)
+    , mNewParticles(device, particles.Size() / sizeof(Particle))
+    , mDelta(device, CellCount(size))
+    , mCount(device, CellCount(size))
+    , mIndex(device, CellCount(size))
+    , mRandomState(device)
+    , mStatus(device, 1, Renderer::MemoryUsage::Cpu)
     , mDispatchParams(device)
     , mLocalDispatchParams(device, 1, Renderer::MemoryUsage::Cpu)
     , mNewDispatchParams(device)
+    , mKeptDispatchParams(device)
     , mParticleCountWork(device, Renderer::ComputeSize::Default1D(), SPIRV::ParticleCount_comp)
-    , mParticleCountBound(mParticleCountWork.Bind(Renderer::ComputeSize{size},
-                                                  {particles, mDispatchParams, mDelta}))
-    , mParticleClampWork(device, Renderer::ComputeSize{size}, SPIRV::ParticleClamp_comp)
-    , mParticleClampBound(mParticleClampWork.Bind(Renderer::ComputeSize{size}, {mDelta}))
-    , mPrefixScan(device, size.x * size.y)
+    , mParticleClampWork(device,
+                         Renderer::ComputeSize{size},
+                         SPIRV::ParticleClamp_comp,
+                         Renderer::SpecConst(Renderer::SpecConstValue(3, particlesPerCell)))
+    , mPrefixScan(device, CellCount(size))
     , mPrefixScanBound(mPrefixScan.Bind(mDelta, mIndex, mNewDispatchParams))
+    , mParticleOverflowWork(device, Renderer::ComputeSize{size}, SPIRV::ParticleOverflow_comp)
+    , mPrefixScanKeptBound(mPrefixScan.Bind(mDelta, mIndex, mKeptDispatchParams))
     , mParticleBucketWork(device, Renderer::ComputeSize::Default1D(), SPIRV::ParticleBucket_comp)
-    , mParticleBucketBound(
-          mParticleBucketWork.Bind(Renderer::ComputeSize{size},
-                                   {particles, mNewParticles, mIndex, mDelta, mDispatchParams}))
     , mParticleSpawnWork(device, Renderer::ComputeSize{size}, SPIRV::ParticleSpawn_comp)
-    , mParticleSpawnBound(mParticleSpawnWork.Bind({mNewParticles, mIndex, mDelta, mSeeds}))
+    , mParticleDispatchWork(device,
+                            Renderer::ComputeSize::Default1D(),
+                            SPIRV::ParticleDispatch_comp)
     , mParticlePhiWork(device,
                        Renderer::ComputeSize{size},
                        SPIRV::ParticlePhi_comp,
@@ -65,72 +82,163 @@ ParticleCount::ParticleCount(Renderer::Device& device,
     , mParticlePhi(device, false)
     , mParticleToGrid(device, false)
     , mParticleFromGrid(device, false)
+    , mLevelSet(nullptr)
+    , mVelocity(nullptr)
+    , mValid(nullptr)
     , mAlpha(alpha)
 {
   Renderer::CopyFrom(mLocalDispatchParams, params);
+  Renderer::CopyFrom(mStatus, glm::ivec2(params.count));
   device.Execute([&](Renderer::CommandEncoder& command)
                  { mDispatchParams.CopyFrom(command, mLocalDispatchParams); });
 
-  // TODO clamp should be configurable
+  SetSeed(0);
+  ScanBind();
+
+  mDispatchCountWork.Record([&](Renderer::CommandEncoder& command)
+                            { mLocalDispatchParams.CopyFrom(command, mDispatchParams); });
+}
+
+void ParticleCount::ScanBind()
+{
+  mParticleCountBound = mParticleCountWork.Bind(Renderer::ComputeSize{mSize},
+                                                {mParticles, mDispatchParams, mDelta});
+  mParticleClampBound = mParticleClampWork.Bind(Renderer::ComputeSize{mSize}, {mDelta, *this});
+  mParticleOverflowBound = mParticleOverflowWork.Bind({mCount, mDelta, mNewDispatchParams});
+  mParticleBucketBound = mParticleBucketWork.Bind(
+      Renderer::ComputeSize{mSize}, {mParticles, mNewParticles, mIndex, mDelta, mDispatchParams});
+  mParticleSpawnBound = mParticleSpawnWork.Bind(
+      {mNewParticles, mIndex, mDelta, mRandomState, mNewDispatchParams, *this});
+  mParticleDispatchBound = mParticleDispatchWork.Bind(
+      {mNewDispatchParams, mKeptDispatchParams, mDispatchParams, mStatus, mRandomState});
 
   // Algorithm
-  // 1) copy this to mDelta
-  //    -> this sets the number of particles we want to add or remove in each
-  //    grid cell
+  // Grid cells are indexed in tiles of 8x8 so that the particles end up
+  // sorted by tiles, which keeps the particle to grid transfers local.
+  // 1) clear mDelta
   // 2) for each particle, increase count in grid cell mDelta
-  // 3) clamp grid cell of mDelta count between [0, 8]
-  //    -> now mDelta contains the number of particles we want in each cell.
-  //       which means deleting some or add some
-  // 4) copy mDelta to mCount
+  // 3) copy mDelta to mCount
   //    -> we save the count of particles in mCount as we'll modify mDelta
-  // 5) prefix scan from mDelta to mIndex
+  // 4) add this to mDelta and clamp grid cell of mDelta count between
+  //    [0, particles per cell]
+  //    -> this is the number of particles we want to add or remove in each
+  //       grid cell, so now mDelta contains the number of particles we want in
+  //       each cell, which means deleting some or add some
+  // 5) prefix scan from mDelta to get the total number of particles wanted
+  // 6) if they fit in the buffers, copy mDelta to mCount, otherwise copy mCount
+  //    to mDelta
+  //    -> mCount and mDelta now contain the number of particles kept in each
+  //       cell, which is the current number if they don't fit
+  // 7) prefix scan from mDelta to mIndex
   //    -> mIndex now maps from grid cell to particle index
-  // 6) for each particle, if count in grid cell mDelta > 0, copy to new
+  // 8) for each particle, if count in grid cell mDelta > 0, copy to new
   // particles and decrease count
   //    -> using the mIndex mapping to get the index in the new particles buffer
-  // 7) for each grid cell mDelta > 0, add new particle in new particles
-  //    -> set the new particles with random position
-  // 8) copy new particles to particles
+  // 9) for each grid cell mDelta > 0, add new particle in new particles
+  //    -> set the new particles with random position, and clear this
+  //       the random positions are hashed from the seed, frame and grid cell
+  // 10) copy new particles to particles
+  // If the particles don't fit in the buffers, 8) only sorts the particles and
+  // 9) doesn't clear this, so the delta is applied once the buffers are grown
+  // with Reserve. Either way mCount and mIndex describe the particles buffer.
 
   mScanWork.Record(
       [&](Renderer::CommandEncoder& command)
       {
         command.DebugMarkerBegin("Particle count", {0.14f, 0.39f, 0.12f, 1.0f});
-        mDelta.CopyFrom(command, *this);
-        Clear(command, std::array<int, 4>{0, 0, 0, 0});
+        mDelta.Clear(command);
+        mDelta.Barrier(command, Renderer::Access::Write, Renderer::Access::Write);
         mParticleCountBound.RecordIndirect(command, mDispatchParams);
         mDelta.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+        mCount.CopyFrom(command, mDelta);
+        Barrier(command,
+                Renderer::ImageLayout::General,
+                Renderer::Access::Write,
+                Renderer::ImageLayout::General,
+                Renderer::Access::Read);
         mParticleClampBound.Record(command);
         mDelta.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
-        mCount.CopyFrom(command, mDelta);
         command.DebugMarkerEnd();
 
         command.DebugMarkerBegin("Particle scan", {0.59f, 0.20f, 0.35f, 1.0f});
         mPrefixScanBound.Record(command);
+        mParticleOverflowBound.PushConstant(command, GetCapacity());
+        mParticleOverflowBound.Record(command);
+        mDelta.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+        mCount.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+        mPrefixScanKeptBound.Record(command);
         mParticleBucketBound.RecordIndirect(command, mDispatchParams);
         mNewParticles.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
         mParticleSpawnBound.Record(command);
         mNewParticles.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
-        particles.CopyFrom(command, mNewParticles);
-        mDispatchParams.CopyFrom(command, mNewDispatchParams);
+        Barrier(command,
+                Renderer::ImageLayout::General,
+                Renderer::Access::Write,
+                Renderer::ImageLayout::General,
+                Renderer::Access::Write);
+        mParticles.CopyFrom(command, mNewParticles);
+        mParticleDispatchBound.Record(command);
+        mDispatchParams.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+        mStatus.Barrier(command, Renderer::Access::Write, Renderer::Access::HostRead);
         command.DebugMarkerEnd();
       });
-
-  mDispatchCountWork.Record([&](Renderer::CommandEncoder& command)
-                            { mLocalDispatchParams.CopyFrom(command, mDispatchParams); });
 }
 
 void ParticleCount::Scan()
 {
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<> dis;
+  mScanWork.Submit();
+}
 
-  std::vector<glm::ivec2> seeds = {
-      {dis(gen), dis(gen)}, {dis(gen), dis(gen)}, {dis(gen), dis(gen)}, {dis(gen), dis(gen)}};
+void ParticleCount::SetSeed(std::uint32_t seed)
+{
+  Renderer::Buffer<glm::uvec2> localRandomState(mDevice, 1, Renderer::MemoryUsage::Cpu);
+  Renderer::CopyFrom(localRandomState, glm::uvec2(seed, 0));
+  mDevice.Execute([&](Renderer::CommandEncoder& command)
+                  { mRandomState.CopyFrom(command, localRandomState); });
+}
 
-  Renderer::CopyFrom(mSeeds, seeds);
-  mScanWork.Submit();
+int ParticleCount::GetCapacity() const
+{
+  return static_cast<int>(mParticles.Size() / sizeof(Particle));
+}
+
+int ParticleCount::GetRequiredCapacity()
+{
+  glm::ivec2 status;
+  Renderer::CopyTo(mStatus, status);
+  return status.x;
+}
+
+bool ParticleCount::Reserve(int capacity)
+{
+  capacity = std::min(capacity, mParticlesPerCell * mSize.x * mSize.y);
+  if (capacity <= GetCapacity())
+    return false;
+
+  mDevice.WaitIdle();
+
+  // keep the current particles in the new particles buffer while growing
+  auto oldSize = mParticles.Size();
+  mDevice.Execute([&](Renderer::CommandEncoder& command)
+                  { mNewParticles.CopyFrom(command, mParticles); });
+
+  mParticles.Resize(capacity * sizeof(Particle));
+  mDevice.Execute([&](Renderer::CommandEncoder& command)
+                  { mParticles.CopyFrom(command, mNewParticles, oldSize); });
+
+  mNewParticles.Resize(capacity * sizeof(Particle));
+
+  ScanBind();
+  if (mLevelSet)
+  {
+    LevelSetBind(*mLevelSet);
+  }
+  if (mVelocity && mValid)
+  {
+    VelocitiesBind(*mVelocity, *mValid);
+  }
+
+  return true;
 }
 
 int ParticleCount::GetTotalCount()
@@ -142,6 +250,21 @@ int ParticleCount::GetTotalCount()
   return params.count;
 }
 
+int ParticleCount::GetLastTotalCount()
+{
+  glm::ivec2 status;
+  Renderer::CopyTo(mStatus, status);
+  return status.y;
+}
+
+void ParticleCount::SetTotalCount(int count)
+{
+  Renderer::CopyFrom(mLocalDispatchParams, Renderer::DispatchParams(count));
+  Renderer::CopyFrom(mStatus, glm::ivec2(count));
+  mDevice.Execute([&](Renderer::CommandEncoder& command)
+                  { mDispatchParams.CopyFrom(command, mLocalDispatchParams); });
+}
+
 Renderer::IndirectBuffer<Renderer::DispatchParams>& ParticleCount::GetDispatchParams()
 {
   return mDispatchParams;
@@ -149,6 +272,7 @@ Renderer::IndirectBuffer<Renderer::DispatchParams>& ParticleCount::GetDispatchPa
 
 void ParticleCount::LevelSetBind(LevelSet& levelSet)
 {
+  mLevelSet = &levelSet;
   mParticlePhiBound = mParticlePhiWork.Bind({mCount, mParticles, mIndex, levelSet});
   mParticlePhi.Record(
       [&](Renderer::CommandEncoder& command)
@@ -177,6 +301,8 @@ void ParticleCount::Phi()
 
 void ParticleCount::VelocitiesBind(Velocity& velocity, Renderer::GenericBuffer& valid)
 {
+  mVelocity = &velocity;
+  mValid = &valid;
   mParticleToGridBound = mParticleToGridWork.Bind({mCount, mParticles, mIndex, velocity, valid});
   mParticleToGrid.Record(
       [&](Renderer::CommandEncoder& command)
@@ -31,13 +31,25 @@ VORTEX_API float DefaultParticleSize();
 class ParticleCount : public Renderer::RenderTexture
 {
 public:
+  /**
+   * @brief Initialize the particle count.
+   * @param device vulkan device
+   * @param size size of the grid
+   * @param particles particle buffer, its size is the initial capacity
+   * @param interpolationMode interpolation of the velocities
+   * @param params initial number of particles
+   * @param alpha PIC/FLIP ratio
+   * @param particleSize radius of the particles
+   * @param particlesPerCell maximum number of particles in a grid cell
+   */
   VORTEX_API ParticleCount(Renderer::Device& device,
                            const glm::ivec2& size,
                            Renderer::GenericBuffer& particles,
                            Velocity::InterpolationMode interpolationMode,
                            const Renderer::DispatchParams& params = {0},
                            float alpha = 1.0f,
-                           float particleSize = DefaultParticleSize());
+                           float particleSize = DefaultParticleSize(),
+                           int particlesPerCell = 8);
 
   /**
    * @brief Count the number of particles and update the internal data
@@ -46,11 +58,58 @@ public:
   VORTEX_API void Scan();
 
   /**
-   * @brief Calculate the total number of particles and return it.
+   * @brief Set the seed of the random positions of new particles, for the
+   * same seed and sequence of scans, the same particles are spawned.
+   * @param seed the seed
+   */
+  VORTEX_API void SetSeed(std::uint32_t seed);
+
+  /**
+   * @brief Calculate the total number of particles and return it. Blocking,
+   * see @ref GetLastTotalCount.
    * @return
    */
   VORTEX_API int GetTotalCount();
 
+  /**
+   * @brief The total number of particles after the last completed scan.
+   * Non-blocking: the count is written to a mapped buffer at the end of each
+   * scan, so it can lag behind by the scans still running on the device.
+   * @return
+   */
+  VORTEX_API int GetLastTotalCount();
+
+  /**
+   * @brief Set the total number of particles, e.g. after copying particles in
+   * the buffer.
+   * @param count the number of particles
+   */
+  VORTEX_API void SetTotalCount(int count);
+
+  /**
+   * @brief The number of particles the particle buffer can hold.
+   */
+  VORTEX_API int GetCapacity() const;
+
+  /**
+   * @brief The number of particles requested by the last scan. If it is bigger
+   * than the capacity, the scan kept the particles that were in the grid,
+   * without adding or removing any, and the buffers need to be grown with
+   * @ref Reserve. This doesn't wait for the scan to finish, so it can lag
+   * behind.
+   */
+  VORTEX_API int GetRequiredCapacity();
+
+  /**
+   * @brief Grow the particle buffers, keeping the current particles. This
+   * waits for the device to be idle and invalidates the particle buffer handle,
+   * other works using it need to be bound again.
+   * @param capacity the number of particles, at most the particles per cell
+   * times the grid size.
+   * @return true if the buffers were grown
+   */
+  VORTEX_API bool Reserve(int capacity);
+
   /**
    * @brief Calculate the dispatch parameters to use on the particle buffer
    * @return
@@ -87,16 +146,21 @@ public:
   VORTEX_API void TransferFromGrid();
 
 private:
+  void ScanBind();
+
   Renderer::Device& mDevice;
   glm::ivec2 mSize;
+  int mParticlesPerCell;
   Renderer::GenericBuffer& mParticles;
   Renderer::Buffer<Particle> mNewParticles;
   Renderer::Buffer<int> mDelta, mCount;
   Renderer::Buffer<int> mIndex;
-  Renderer::Buffer<glm::ivec2> mSeeds;
+  Renderer::Buffer<glm::uvec2> mRandomState;
+  Renderer::Buffer<glm::ivec2> mStatus;
 
   Renderer::IndirectBuffer<Renderer::DispatchParams> mDispatchParams;
-  Renderer::Buffer<Renderer::DispatchParams> mLocalDispatchParams, mNewDispatchParams;
+  Renderer::Buffer<Renderer::DispatchParams> mLocalDispatchParams, mNewDispatchParams,
+      mKeptDispatchParams;
 
   Renderer::Work mParticleCountWork;
   Renderer::Work::Bound mParticleCountBound;
@@ -104,10 +168,15 @@ private:
   Renderer::Work::Bound mParticleClampBound;
   PrefixScan mPrefixScan;
   PrefixScan::Bound mPrefixScanBound;
+  Renderer::Work mParticleOverflowWork;
+  Renderer::Work::Bound mParticleOverflowBound;
+  PrefixScan::Bound mPrefixScanKeptBound;
   Renderer::Work mParticleBucketWork;
   Renderer::Work::Bound mParticleBucketBound;
   Renderer::Work mParticleSpawnWork;
   Renderer::Work::Bound mParticleSpawnBound;
+  Renderer::Work mParticleDispatchWork;
+  Renderer::Work::Bound mParticleDispatchBound;
   Renderer::Work mParticlePhiWork;
   Renderer::Work::Bound mParticlePhiBound;
   Renderer::Work mParticleToGridWork;
@@ -121,6 +190,10 @@ private:
   Renderer::CommandBuffer mParticleToGrid;
   Renderer::CommandBuffer mParticleFromGrid;
 
+  LevelSet* mLevelSet;
+  Velocity* mVelocity;
+  Renderer::GenericBuffer* mValid;
+
   float mAlpha;
 };
 
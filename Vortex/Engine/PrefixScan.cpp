@@ -32,21 +32,27 @@ Renderer::ComputeSize MakeComputeSize(int size)
 }
 }  // namespace
 
-PrefixScan::PrefixScan(Renderer::Device& device, int size)
+PrefixScan::PrefixScan(Renderer::Device& device, int size, Mode mode)
     : mSize(size)
+    , mMode(mode)
     , mAddWork(device, Renderer::ComputeSize::Default1D(), SPIRV::PreScanAdd_comp)
     , mPreScanWork(device, Renderer::ComputeSize::Default1D(), SPIRV::PreScan_comp)
     , mPreScanStoreSumWork(device, Renderer::ComputeSize::Default1D(), SPIRV::PreScanStoreSum_comp)
+    , mPreScanLookBackWork(device, Renderer::ComputeSize::Default1D(), SPIRV::PreScanLookBack_comp)
+    , mTileStatus(device, mode == Mode::SinglePass ? MakeComputeSize(size).WorkSize.x + 1 : 1)
 {
-  auto localSize = Renderer::ComputeSize::GetLocalSize1D();
-  int workGroupSize = mSize;
-
-  while ((workGroupSize = GetWorkGroupSize(workGroupSize, localSize)) > 1)
+  if (mMode == Mode::MultiLevel)
   {
-    mPartialSums.emplace_back(device, workGroupSize);
-  }
+    auto localSize = Renderer::ComputeSize::GetLocalSize1D();
+    int workGroupSize = mSize;
 
-  assert(workGroupSize);
+    while ((workGroupSize = GetWorkGroupSize(workGroupSize, localSize)) > 1)
+    {
+      mPartialSums.emplace_back(device, workGroupSize);
+    }
+
+    assert(workGroupSize);
+  }
 }
 
 void PrefixScan::BindRecursive(std::vector<Renderer::CommandBuffer::CommandFn>& bufferBarriers,
@@ -104,19 +110,46 @@ PrefixScan::Bound PrefixScan::Bind(Renderer::GenericBuffer& input,
   std::vector<Renderer::CommandBuffer::CommandFn> bufferBarriers;
   std::vector<Renderer::Work::Bound> bounds;
 
+  if (mMode == Mode::SinglePass)
+  {
+    bounds.emplace_back(mPreScanLookBackWork.Bind(MakeComputeSize(mSize),
+                                                  {input, output, dispatchParams, mTileStatus}));
+
+    bufferBarriers.emplace_back(
+        [&](Renderer::CommandEncoder& command)
+        {
+          output.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+          dispatchParams.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+        });
+
+    return Bound(bufferBarriers,
+                 std::move(bounds),
+                 [&](Renderer::CommandEncoder& command)
+                 {
+                   mTileStatus.Clear(command);
+                   mTileStatus.Barrier(command, Renderer::Access::Write, Renderer::Access::Write);
+                 });
+  }
+
   BindRecursive(bufferBarriers, bounds, input, output, dispatchParams, MakeComputeSize(mSize), 0);
 
   return Bound(bufferBarriers, std::move(bounds));
 }
 
 PrefixScan::Bound::Bound(const std::vector<Renderer::CommandBuffer::CommandFn>& bufferBarriers,
-                         std::vector<Renderer::Work::Bound>&& bounds)
-    : mBufferBarriers(bufferBarriers), mBounds(std::move(bounds))
+                         std::vector<Renderer::Work::Bound>&& bounds,
+                         Renderer::CommandBuffer::CommandFn clear)
+    : mClear(clear), mBufferBarriers(bufferBarriers), mBounds(std::move(bounds))
 {
 }
 
 void PrefixScan::Bound::Record(Renderer::CommandEncoder& command)
 {
+  if (mClear)
+  {
+    mClear(command);
+  }
+
   for (std::size_t i = 0; i < mBounds.size(); i++)
   {
     mBounds[i].Record(command);
@@ -27,6 +27,19 @@ void PrefixSym(int input[], int n, int output[])
 class PrefixScan
 {
 public:
+  /**
+   * @brief Algorithm used to scan the input.
+   */
+  enum class Mode
+  {
+    // A single dispatch, where each work group gets the prefix of the previous
+    // work groups with a decoupled look-back.
+    SinglePass,
+    // Recursive scan of the sums of each work group, requiring two dispatches
+    // per level.
+    MultiLevel,
+  };
+
   /**
    * @brief A prefix scan object bound with input/output buffers, ready to be
    * dispatched.
@@ -40,13 +53,15 @@ public:
 
   private:
     Bound(const std::vector<Renderer::CommandBuffer::CommandFn>& bufferBarriers,
-          std::vector<Renderer::Work::Bound>&& bounds);
+          std::vector<Renderer::Work::Bound>&& bounds,
+          Renderer::CommandBuffer::CommandFn clear = {});
 
+    Renderer::CommandBuffer::CommandFn mClear;
     std::vector<Renderer::CommandBuffer::CommandFn> mBufferBarriers;
     std::vector<Renderer::Work::Bound> mBounds;
   };
 
-  VORTEX_API PrefixScan(Renderer::Device& device, int size);
+  VORTEX_API PrefixScan(Renderer::Device& device, int size, Mode mode = Mode::SinglePass);
 
   VORTEX_API Bound Bind(Renderer::GenericBuffer& input,
                         Renderer::GenericBuffer& output,
@@ -62,11 +77,14 @@ private:
                      std::size_t level);
 
   int mSize;
+  Mode mMode;
   Renderer::Work mAddWork;
   Renderer::Work mPreScanWork;
   Renderer::Work mPreScanStoreSumWork;
+  Renderer::Work mPreScanLookBackWork;
 
   std::vector<Renderer::Buffer<int>> mPartialSums;
+  Renderer::Buffer<int> mTileStatus;
 };
 
 }  // namespace Fluid
@@ -24,11 +24,11 @@ Pressure::Pressure(Renderer::Device& device,
     : mData(data)
     , mBuildMatrix(device, Renderer::ComputeSize{size}, SPIRV::BuildMatrix_comp)
     , mBuildMatrixBound(mBuildMatrix.Bind({data.Diagonal, data.Lower, liquidPhi, solidPhi}))
+    , mBuildMatrixHalf(device, Renderer::ComputeSize{size}, SPIRV::BuildMatrixHalf_comp)
     , mBuildDiv(device, Renderer::ComputeSize{size}, SPIRV::BuildDiv_comp)
     , mBuildDivBound(mBuildDiv.Bind({data.B, data.Diagonal, liquidPhi, solidPhi, velocity}))
     , mProject(device, Renderer::ComputeSize{size}, SPIRV::Project_comp)
-    , mProjectBound(
-          mProject.Bind({data.X, liquidPhi, solidPhi, velocity, velocity.Output(), valid}))
+    , mProjectBound(mProject.Bind({data.X, liquidPhi, solidPhi, velocity, valid}))
     , mBuildEquationCmd(device, false)
     , mProjectCmd(device, false)
 {
@@ -54,12 +54,11 @@ Pressure::Pressure(Renderer::Device& device,
         mProjectBound.PushConstant(command, dt);
         mProjectBound.Record(command);
         valid.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
-        velocity.Output().Barrier(command,
-                                  Renderer::ImageLayout::General,
-                                  Renderer::Access::Write,
-                                  Renderer::ImageLayout::General,
-                                  Renderer::Access::Read);
-        velocity.CopyBack(command);
+        velocity.Barrier(command,
+                         Renderer::ImageLayout::General,
+                         Renderer::Access::Write,
+                         Renderer::ImageLayout::General,
+                         Renderer::Access::Read);
         command.DebugMarkerEnd();
       });
 }
@@ -68,9 +67,12 @@ Renderer::Work::Bound Pressure::BindMatrixBuild(const glm::ivec2& size,
                                                 Renderer::GenericBuffer& diagonal,
                                                 Renderer::GenericBuffer& lower,
                                                 Renderer::Texture& liquidPhi,
-                                                Renderer::Texture& solidPhi)
+                                                Renderer::Texture& solidPhi,
+                                                LinearSolver::Precision precision)
 {
-  return mBuildMatrix.Bind(Renderer::ComputeSize{size}, {diagonal, lower, liquidPhi, solidPhi});
+  auto& work = precision == LinearSolver::Precision::Half ? mBuildMatrixHalf : mBuildMatrix;
+  return work.Bind(LinearSolver::MakeComputeSize(size, precision),
+                   {diagonal, lower, liquidPhi, solidPhi});
 }
 
 void Pressure::BuildLinearEquation()
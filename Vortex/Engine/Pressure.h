@@ -40,13 +40,16 @@ public:
    * @param lower lower matrix of A
    * @param liquidPhi liquid level set
    * @param solidPhi solid level set
+   * @param precision storage of @p diagonal and @p lower
    * @return
    */
-  Renderer::Work::Bound BindMatrixBuild(const glm::ivec2& size,
-                                        Renderer::GenericBuffer& diagonal,
-                                        Renderer::GenericBuffer& lower,
-                                        Renderer::Texture& liquidPhi,
-                                        Renderer::Texture& solidPhi);
+  Renderer::Work::Bound BindMatrixBuild(
+      const glm::ivec2& size,
+      Renderer::GenericBuffer& diagonal,
+      Renderer::GenericBuffer& lower,
+      Renderer::Texture& liquidPhi,
+      Renderer::Texture& solidPhi,
+      LinearSolver::Precision precision = LinearSolver::Precision::Single);
 
   /**
    * @brief Build the matrix A and right hand side b.
@@ -63,6 +66,7 @@ private:
   LinearSolver::Data& mData;
   Renderer::Work mBuildMatrix;
   Renderer::Work::Bound mBuildMatrixBound;
+  Renderer::Work mBuildMatrixHalf;
   Renderer::Work mBuildDiv;
   Renderer::Work::Bound mBuildDivBound;
   Renderer::Work mProject;
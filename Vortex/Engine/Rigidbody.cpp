@@ -73,6 +73,15 @@ void RigidBody::SetVelocities(const glm::vec2& velocity, float angularVelocity)
   mVelocityCmd.Submit();
 }
 
+RigidBody::Velocity RigidBody::GetVelocities()
+{
+  Velocity v;
+  Renderer::CopyTo(mLocalVelocity, v);
+
+  v.velocity *= glm::vec2(mSize);
+  return v;
+}
+
 RigidBody::Velocity RigidBody::GetForces()
 {
   mForceCmd.Wait();
@@ -118,13 +127,17 @@ void RigidBody::BindDiv(Renderer::GenericBuffer& div, Renderer::GenericBuffer& d
 
 void RigidBody::BindVelocityConstrain(Fluid::Velocity& velocity)
 {
-  mConstrainBound = mConstrain.Bind({velocity, velocity.Output(), mPhi, mVelocity, mCenter});
+  mConstrainBound = mConstrain.Bind({velocity, mPhi, mVelocity, mCenter});
   mConstrainCmd.Record(
       [&](Renderer::CommandEncoder& command)
       {
         command.DebugMarkerBegin("Rigidbody constrain", {0.29f, 0.36f, 0.21f, 1.0f});
         mConstrainBound.Record(command);
-        velocity.CopyBack(command);
+        velocity.Barrier(command,
+                         Renderer::ImageLayout::General,
+                         Renderer::Access::Write,
+                         Renderer::ImageLayout::General,
+                         Renderer::Access::Read);
         command.DebugMarkerEnd();
       });
 }
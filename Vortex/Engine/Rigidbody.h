@@ -86,6 +86,12 @@ public:
    */
   VORTEX_API void SetVelocities(const glm::vec2& velocity, float angularVelocity);
 
+  /**
+   * @brief Get the velocities and angular velocities last set with @ref SetVelocities
+   * @return the velocity and angular velocity of the body
+   */
+  VORTEX_API Velocity GetVelocities();
+
   /**
    * @brief Upload the transform matrix to the GPU.
    */
@@ -0,0 +1,103 @@
+//
+//  TimeStep.cpp
+//  Vortex
+//
+
+#include "TimeStep.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "vortex_generated_spirv.h"
+
+namespace Vortex
+{
+namespace Fluid
+{
+TimeStep::TimeStep(Renderer::Device& device,
+                   const glm::ivec2& size,
+                   Velocity& velocity,
+                   Renderer::GenericBuffer& timeScale,
+                   float dt,
+                   float substepDt,
+                   float targetCfl,
+                   int maxSubSteps)
+    : mMaxSubSteps(maxSubSteps)
+    , mVelocityMaxWork(device, Renderer::ComputeSize{size}, SPIRV::VelocityMax_comp)
+    , mVelocityMax(device, size.x * size.y)
+    , mMaxVelocity(device, 1)
+    , mState(device, 1)
+    , mStatus(device, 1, Renderer::MemoryUsage::Cpu)
+    , mReduceVelocityMax(device, size.x * size.y)
+    , mTimeStepWork(device, Renderer::ComputeSize::Default1D(), SPIRV::TimeStep_comp)
+    , mBeginCmd(device, false)
+    , mSubstepCmd(device, false)
+{
+  if (maxSubSteps < 1)
+  {
+    throw std::runtime_error("Invalid number of substeps");
+  }
+
+  Renderer::CopyFrom(mStatus, Status{(int)std::lround(dt / substepDt), 0.0f});
+
+  mVelocityMaxBound = mVelocityMaxWork.Bind({velocity, mVelocityMax});
+  mReduceVelocityMaxBound = mReduceVelocityMax.Bind(mVelocityMax, mMaxVelocity);
+  mTimeStepBound = mTimeStepWork.Bind({mMaxVelocity, mState, timeScale, mStatus});
+
+  auto record = [&](Renderer::CommandBuffer& cmd, int begin)
+  {
+    cmd.Record(
+        [&](Renderer::CommandEncoder& command)
+        {
+          command.DebugMarkerBegin("Time step", {0.65f, 0.97f, 0.78f, 1.0f});
+
+          mVelocityMaxBound.Record(command);
+          mVelocityMax.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+          mReduceVelocityMaxBound.Record(command);
+          mMaxVelocity.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+          mTimeStepBound.PushConstant(command, size.x, dt, substepDt, targetCfl, begin);
+          mTimeStepBound.Record(command);
+          mState.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+          timeScale.Barrier(command, Renderer::Access::Write, Renderer::Access::Read);
+
+          command.DebugMarkerEnd();
+        });
+  };
+
+  record(mBeginCmd, 1);
+  record(mSubstepCmd, 0);
+}
+
+void TimeStep::Begin()
+{
+  mBeginCmd.Submit();
+}
+
+void TimeStep::Substep()
+{
+  mSubstepCmd.Submit();
+}
+
+int TimeStep::GetSubSteps()
+{
+  Status status;
+  Renderer::CopyTo(mStatus, status);
+
+  return std::max(1, std::min(status.SubSteps, mMaxSubSteps));
+}
+
+int TimeStep::GetMaxSubSteps() const
+{
+  return mMaxSubSteps;
+}
+
+float TimeStep::GetDroppedTime()
+{
+  Status status;
+  Renderer::CopyTo(mStatus, status);
+
+  return status.DroppedTime;
+}
+
+}  // namespace Fluid
+}  // namespace Vortex
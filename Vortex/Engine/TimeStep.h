@@ -0,0 +1,100 @@
+//
+//  TimeStep.h
+//  Vortex
+//
+
+#pragma once
+
+#include <Vortex/Engine/LinearSolver/Reduce.h>
+#include <Vortex/Engine/Velocity.h>
+#include <Vortex/Renderer/CommandBuffer.h>
+#include <Vortex/Renderer/Work.h>
+
+namespace Vortex
+{
+namespace Fluid
+{
+/**
+ * @brief Adaptive time steps driven by the CFL number, computed on the device.
+ * A step of size dt is split in substeps small enough to respect the target
+ * CFL number, the size of each substep is written in a buffer used to scale
+ * the time step of the advection, without any read back to the host.
+ */
+class TimeStep
+{
+public:
+  /**
+   * @brief Initialize the adaptive time steps
+   * @param device vulkan device
+   * @param size size of the velocity field
+   * @param velocity the velocity field
+   * @param timeScale buffer with a single float, written with the scale of
+   * each substep relative to substepDt
+   * @param dt the time step to split in substeps
+   * @param substepDt the time step the advection is recorded with
+   * @param targetCfl the CFL number each substep should respect
+   * @param maxSubSteps maximum number of substeps
+   */
+  VORTEX_API TimeStep(Renderer::Device& device,
+                      const glm::ivec2& size,
+                      Velocity& velocity,
+                      Renderer::GenericBuffer& timeScale,
+                      float dt,
+                      float substepDt,
+                      float targetCfl,
+                      int maxSubSteps);
+
+  /**
+   * @brief Start a new step, computes the number of substeps. Non-blocking.
+   */
+  VORTEX_API void Begin();
+
+  /**
+   * @brief Compute the size of the next substep and write it to the time scale
+   * buffer. Once the time of the step is done, the size is zero. Non-blocking.
+   */
+  VORTEX_API void Substep();
+
+  /**
+   * @brief Number of substeps for the step, as computed by the last completed
+   * @ref Begin. Non-blocking: it is read from a mapped buffer and can lag
+   * behind by the steps still running on the device.
+   * @return number of substeps, between 1 and maxSubSteps
+   */
+  VORTEX_API int GetSubSteps();
+
+  /**
+   * @brief The maximum number of substeps of a step.
+   */
+  VORTEX_API int GetMaxSubSteps() const;
+
+  /**
+   * @brief Time of the step left after the last completed @ref Substep. Once
+   * all the substeps of a step are done, this is the time that was dropped
+   * because there weren't enough substeps. Non-blocking, like
+   * @ref GetSubSteps.
+   * @return the dropped time, 0 if the step was completed
+   */
+  VORTEX_API float GetDroppedTime();
+
+private:
+  struct Status
+  {
+    int SubSteps;
+    float DroppedTime;
+  };
+
+  int mMaxSubSteps;
+  Renderer::Work mVelocityMaxWork;
+  Renderer::Work::Bound mVelocityMaxBound;
+  Renderer::Buffer<float> mVelocityMax, mMaxVelocity, mState;
+  Renderer::Buffer<Status> mStatus;
+  ReduceMax mReduceVelocityMax;
+  ReduceMax::Bound mReduceVelocityMaxBound;
+  Renderer::Work mTimeStepWork;
+  Renderer::Work::Bound mTimeStepBound;
+  Renderer::CommandBuffer mBeginCmd, mSubstepCmd;
+};
+
+}  // namespace Fluid
+}  // namespace Vortex
@@ -5,8 +5,6 @@
 
 #include "Velocity.h"
 
-#include "vortex_generated_spirv.h"
-
 namespace Vortex
 {
 namespace Fluid
@@ -16,27 +14,10 @@ Velocity::Velocity(Renderer::Device& device, const glm::ivec2& size)
     , mDevice(device)
     , mOutputVelocity(device, size.x, size.y, Renderer::Format::R32G32Sfloat)
     , mDVelocity(device, size.x, size.y, Renderer::Format::R32G32Sfloat)
-    , mVelocityDiff(device, Renderer::ComputeSize{size}, SPIRV::VelocityDifference_comp)
-    , mVelocityDiffBound(mVelocityDiff.Bind({mDVelocity, *this, mOutputVelocity}))
     , mSaveCopyCmd(device, false)
-    , mVelocityDiffCmd(device, false)
 {
   mSaveCopyCmd.Record([&](Renderer::CommandEncoder& command)
                       { mDVelocity.CopyFrom(command, *this); });
-
-  mVelocityDiffCmd.Record(
-      [&](Renderer::CommandEncoder& command)
-      {
-        command.DebugMarkerBegin("Velocity diff", {0.32f, 0.60f, 0.67f, 1.0f});
-        mVelocityDiffBound.Record(command);
-        mOutputVelocity.Barrier(command,
-                                Renderer::ImageLayout::General,
-                                Renderer::Access::Write,
-                                Renderer::ImageLayout::General,
-                                Renderer::Access::Read);
-        mDVelocity.CopyFrom(command, mOutputVelocity);
-        command.DebugMarkerEnd();
-      });
 }
 
 Renderer::Texture& Velocity::Output()
@@ -64,10 +45,5 @@ void Velocity::SaveCopy()
   mSaveCopyCmd.Submit();
 }
 
-void Velocity::VelocityDiff()
-{
-  mVelocityDiffCmd.Submit();
-}
-
 }  // namespace Fluid
 }  // namespace Vortex
@@ -18,7 +18,7 @@ namespace Fluid
 /**
  * @brief The Velocity field. Can be used to calculate a difference between
  * different states. Contains three fields: intput and output, used for
- * ping-pong algorithms, and d, the difference between two velocity fields.
+ * ping-pong algorithms, and d, a saved copy of the velocity field.
  */
 class Velocity : public Renderer::RenderTexture
 {
@@ -42,8 +42,8 @@ public:
   VORTEX_API Renderer::Texture& Output();
 
   /**
-   * @brief A difference velocity field, calculated with the difference between
-   * this velocity field, and the output velocity field
+   * @brief A copy of the velocity field, saved with @ref SaveCopy. Used to
+   * calculate the FLIP update of the particles.
    * @return
    */
   VORTEX_API Renderer::Texture& D();
@@ -61,26 +61,16 @@ public:
   VORTEX_API void Clear(Renderer::CommandEncoder& command);
 
   /**
-   * @brief Copy to the difference field.
+   * @brief Copy to the saved velocity field.
    */
   VORTEX_API void SaveCopy();
 
-  /**
-   * @brief Calculate the difference between the difference field and this
-   * velocity field, store it in the diference field.
-   */
-  VORTEX_API void VelocityDiff();
-
 private:
   Renderer::Device& mDevice;
   Renderer::Texture mOutputVelocity;
   Renderer::Texture mDVelocity;
 
-  Renderer::Work mVelocityDiff;
-  Renderer::Work::Bound mVelocityDiffBound;
-
   Renderer::CommandBuffer mSaveCopyCmd;
-  Renderer::CommandBuffer mVelocityDiffCmd;
 };
 
 }  // namespace Fluid
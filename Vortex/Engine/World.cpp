@@ -9,6 +9,7 @@
 #include <glm/gtx/transform.hpp>
 
 #include <algorithm>
+#include <cstring>
 
 namespace Vortex
 {
@@ -41,17 +42,69 @@ glm::ivec2 NextPowerOfTwo(const glm::ivec2& s)
   return {NextPowerOfTwo(s.x), NextPowerOfTwo(s.y)};
 }
 
+void LoadTexture(Renderer::Device& device,
+                 FieldCacheReader& reader,
+                 const std::string& name,
+                 Renderer::Texture& texture)
+{
+  if (reader.GetSize(name) != glm::ivec2(texture.GetWidth(), texture.GetHeight()) ||
+      reader.GetFormat(name) != texture.GetFormat())
+  {
+    throw std::runtime_error("Invalid checkpoint field " + name);
+  }
+
+  std::vector<std::uint8_t> data;
+  reader.Read(0, name, data);
+
+  Renderer::Texture input(device,
+                          texture.GetWidth(),
+                          texture.GetHeight(),
+                          texture.GetFormat(),
+                          Renderer::MemoryUsage::Cpu);
+  input.CopyFrom(data.data());
+  device.Execute([&](Renderer::CommandEncoder& command) { texture.CopyFrom(command, input); });
+}
+
+void LoadBuffer(Renderer::Device& device,
+                FieldCacheReader& reader,
+                const std::string& name,
+                Renderer::GenericBuffer& buffer)
+{
+  std::vector<std::uint8_t> data;
+  reader.ReadBuffer(0, name, data);
+  if (data.size() != buffer.Size())
+    throw std::runtime_error("Invalid checkpoint field " + name);
+
+  Renderer::GenericBuffer input(
+      device, Renderer::BufferUsage::Storage, Renderer::MemoryUsage::Cpu, buffer.Size());
+  input.CopyFrom(0, data.data(), static_cast<uint32_t>(data.size()));
+  device.Execute([&](Renderer::CommandEncoder& command) { buffer.CopyFrom(command, input); });
+}
+
+std::uint64_t ParticleBufferSize(const glm::ivec2& size, int particlesPerCell, int capacity)
+{
+  if (capacity <= 0)
+  {
+    capacity = std::max(1, particlesPerCell * size.x * size.y / 4);
+  }
+
+  return capacity * sizeof(Particle);
+}
+
 World::World(Renderer::Device& device,
              const glm::ivec2& size,
              float dt,
              int numSubSteps,
-             Velocity::InterpolationMode interpolationMode)
+             Velocity::InterpolationMode interpolationMode,
+             LinearSolver::Precision precision)
     : mDevice(device)
     , mSize(size)
     , mDelta(dt / numSubSteps)
     , mNumSubSteps(numSubSteps)
+    , mLastSubSteps(numSubSteps)
     , mSolverSize(NextPowerOfTwo(size))
-    , mPreconditioner(device, mSolverSize, mDelta, 2, Multigrid::SmootherSolver::GaussSeidel)
+    , mPreconditioner(
+          device, mSolverSize, mDelta, 2, Multigrid::SmootherSolver::GaussSeidel, precision)
     , mLinearSolver(device, mSolverSize, mPreconditioner)
     , mData(device, mSolverSize)
 #if !defined(NDEBUG)
@@ -76,6 +129,7 @@ World::World(Renderer::Device& device,
     , mCopySolidPhi(device, false)
     , mRigidBodySolver(nullptr)
     , mCfl(device, size, mVelocity)
+    , mComputeLastCfl(false)
 {
   mExtrapolation.ConstrainBind(mDynamicSolidPhi);
   mLiquidPhi.ExtrapolateBind(mDynamicSolidPhi);
@@ -84,6 +138,11 @@ World::World(Renderer::Device& device,
                        { mDynamicSolidPhi.CopyFrom(command, mStaticSolidPhi); });
 
   mPreconditioner.BuildHierarchiesBind(mProjection, mDynamicSolidPhi, mLiquidPhi);
+  // corrects the drift of the residual caused by the half precision hierarchy
+  if (precision == LinearSolver::Precision::Half)
+  {
+    mLinearSolver.SetRefinementSteps(2);
+  }
   mLinearSolver.Bind(mData.Diagonal, mData.Lower, mData.B, mData.X);
 
   mDevice.Execute(
@@ -94,9 +153,31 @@ World::World(Renderer::Device& device,
 
 void World::Step(LinearSolver::Parameters& params)
 {
-  for (int i = 0; i < mNumSubSteps; i++)
+  if (mTimeStep)
+  {
+    mTimeStep->Begin();
+
+    // the number of substeps needed is only known on the device, so the
+    // maximum is submitted and the ones past the step have a size of zero
+    mLastSubSteps = mTimeStep->GetMaxSubSteps();
+    for (int i = 0; i < mLastSubSteps; i++)
+    {
+      mTimeStep->Substep();
+      Substep(params);
+    }
+  }
+  else
+  {
+    mLastSubSteps = mNumSubSteps;
+    for (int i = 0; i < mNumSubSteps; i++)
+    {
+      Substep(params);
+    }
+  }
+
+  if (mComputeLastCfl)
   {
-    Substep(params);
+    mCfl.ComputeAsync();
   }
 }
 
@@ -141,6 +222,11 @@ std::shared_ptr<DistanceField> World::MakeSolidDistanceField()
 
 void World::AddRigidbody(RigidBody& rigidbody)
 {
+  if (mTimeStep)
+  {
+    throw std::runtime_error("Rigid bodies cannot be used with adaptive substeps");
+  }
+
   rigidbody.BindPhi(mDynamicSolidPhi);
   rigidbody.BindDiv(mData.B, mData.Diagonal);
   rigidbody.BindVelocityConstrain(mVelocity);
@@ -158,6 +244,11 @@ void World::RemoveRigidBody(RigidBody& rigidbody)
 
 void World::AttachRigidBodySolver(RigidBodySolver& rigidbodySolver)
 {
+  if (mTimeStep)
+  {
+    throw std::runtime_error("Rigid bodies cannot be used with adaptive substeps");
+  }
+
   mRigidBodySolver = &rigidbodySolver;
 }
 
@@ -181,20 +272,146 @@ float World::GetCFL()
   return mCfl.Get();
 }
 
+float World::GetLastCFL()
+{
+  return mCfl.GetLast();
+}
+
+void World::SetComputeLastCFL(bool enable)
+{
+  mComputeLastCfl = enable;
+}
+
+void World::SetAdaptiveSubSteps(float targetCfl, int maxSubSteps)
+{
+  // the rigid bodies are coupled with mDelta, which isn't the size of the
+  // substeps anymore
+  if (!mRigidbodies.empty() || mRigidBodySolver)
+  {
+    throw std::runtime_error("Rigid bodies cannot be used with adaptive substeps");
+  }
+
+  mTimeStep = std::make_unique<TimeStep>(mDevice,
+                                         mSize,
+                                         mVelocity,
+                                         mAdvection.GetTimeScale(),
+                                         mDelta * mNumSubSteps,
+                                         mDelta,
+                                         targetCfl,
+                                         maxSubSteps);
+}
+
+int World::GetLastSubSteps() const
+{
+  return mLastSubSteps;
+}
+
+float World::GetDroppedTime()
+{
+  return mTimeStep ? mTimeStep->GetDroppedTime() : 0.0f;
+}
+
+void World::SetAdvectionScheme(Advection::Scheme scheme)
+{
+  mAdvection.SetScheme(scheme);
+}
+
 Renderer::Texture& World::GetVelocity()
 {
   return mVelocity;
 }
 
+void World::SaveCheckpoint(const std::string& filename)
+{
+  WaitCheckpoint();
+
+  mCheckpoint = std::make_unique<FieldCacheWriter>(mDevice, filename);
+  CheckpointBind(*mCheckpoint);
+  mCheckpoint->WriteFrame();
+}
+
+void World::WaitCheckpoint()
+{
+  mCheckpoint.reset();
+}
+
+void World::LoadCheckpoint(const std::string& filename)
+{
+  WaitCheckpoint();
+
+  FieldCacheReader reader(filename);
+  if (reader.GetFrameCount() == 0)
+    throw std::runtime_error("Empty checkpoint " + filename);
+
+  CheckpointLoad(reader);
+}
+
+void World::CheckpointBind(FieldCacheWriter& writer)
+{
+  writer.AddField("velocity", mVelocity);
+  writer.AddField("liquid_phi", mLiquidPhi);
+  writer.AddField("solid_phi", mStaticSolidPhi);
+  writer.AddBuffer("pressure", mData.X);
+
+  if (!mRigidbodies.empty())
+  {
+    std::vector<RigidBodyState> states;
+    for (auto& rigidbody : mRigidbodies)
+    {
+      auto velocities = rigidbody->GetVelocities();
+      states.push_back({rigidbody->Position,
+                        velocities.velocity,
+                        rigidbody->Rotation,
+                        velocities.angular_velocity});
+    }
+
+    mRigidbodyStates = std::make_unique<Renderer::Buffer<RigidBodyState>>(
+        mDevice, states.size(), Renderer::MemoryUsage::Cpu);
+    Renderer::CopyFrom(*mRigidbodyStates, states);
+    writer.AddBuffer("rigidbodies", *mRigidbodyStates);
+  }
+}
+
+void World::CheckpointLoad(FieldCacheReader& reader)
+{
+  LoadTexture(mDevice, reader, "velocity", mVelocity);
+  LoadTexture(mDevice, reader, "liquid_phi", mLiquidPhi);
+  LoadTexture(mDevice, reader, "solid_phi", mStaticSolidPhi);
+  LoadBuffer(mDevice, reader, "pressure", mData.X);
+
+  std::vector<std::uint8_t> data;
+  if (reader.HasField("rigidbodies"))
+  {
+    reader.ReadBuffer(0, "rigidbodies", data);
+  }
+
+  if (data.size() != mRigidbodies.size() * sizeof(RigidBodyState))
+    throw std::runtime_error("Mismatch of rigidbodies in checkpoint");
+
+  for (std::size_t i = 0; i < mRigidbodies.size(); i++)
+  {
+    RigidBodyState state;
+    std::memcpy(&state, &data[i * sizeof(RigidBodyState)], sizeof(RigidBodyState));
+
+    mRigidbodies[i]->Position = state.Position;
+    mRigidbodies[i]->Rotation = state.Rotation;
+    mRigidbodies[i]->SetVelocities(state.Velocity, state.AngularVelocity);
+  }
+}
+
 SmokeWorld::SmokeWorld(Renderer::Device& device,
                        const glm::ivec2& size,
                        float dt,
-                       Velocity::InterpolationMode interpolationMode)
-    : World(device, size, dt, 1, interpolationMode)
+                       Velocity::InterpolationMode interpolationMode,
+                       LinearSolver::Precision precision)
+    : World(device, size, dt, 1, interpolationMode, precision)
 {
 }
 
-SmokeWorld::~SmokeWorld() {}
+SmokeWorld::~SmokeWorld()
+{
+  WaitCheckpoint();
+}
 
 void SmokeWorld::Substep(LinearSolver::Parameters& params)
 {
@@ -238,26 +455,68 @@ void SmokeWorld::Substep(LinearSolver::Parameters& params)
 void SmokeWorld::FieldBind(Density& density)
 {
   mAdvection.AdvectBind(density);
+  if (std::find(mDensities.begin(), mDensities.end(), &density) == mDensities.end())
+  {
+    mDensities.push_back(&density);
+  }
+}
+
+void SmokeWorld::FieldUnbind(Density& density)
+{
+  mAdvection.AdvectUnbind(density);
+  mDensities.erase(std::remove(mDensities.begin(), mDensities.end(), &density),
+                   mDensities.end());
+}
+
+void SmokeWorld::CheckpointBind(FieldCacheWriter& writer)
+{
+  World::CheckpointBind(writer);
+  for (std::size_t i = 0; i < mDensities.size(); i++)
+  {
+    writer.AddField("density" + std::to_string(i), *mDensities[i]);
+  }
+}
+
+void SmokeWorld::CheckpointLoad(FieldCacheReader& reader)
+{
+  World::CheckpointLoad(reader);
+  for (std::size_t i = 0; i < mDensities.size(); i++)
+  {
+    LoadTexture(mDevice, reader, "density" + std::to_string(i), *mDensities[i]);
+  }
 }
 
 WaterWorld::WaterWorld(Renderer::Device& device,
                        const glm::ivec2& size,
                        float dt,
                        int numSubSteps,
-                       Velocity::InterpolationMode interpolationMode)
-    : World(device, size, dt, numSubSteps, interpolationMode)
+                       Velocity::InterpolationMode interpolationMode,
+                       int particlesPerCell,
+                       int particleCapacity,
+                       LinearSolver::Precision precision)
+    : World(device, size, dt, numSubSteps, interpolationMode, precision)
     , mParticles(device,
                  Renderer::BufferUsage::Vertex,
                  Renderer::MemoryUsage::Gpu,
-                 8 * size.x * size.y * sizeof(Particle))
-    , mParticleCount(device, size, mParticles, interpolationMode, {0}, 0.02f)
+                 ParticleBufferSize(size, particlesPerCell, particleCapacity))
+    , mParticleCount(device,
+                     size,
+                     mParticles,
+                     interpolationMode,
+                     {0},
+                     0.02f,
+                     DefaultParticleSize(),
+                     particlesPerCell)
 {
   mParticleCount.LevelSetBind(mLiquidPhi);
   mParticleCount.VelocitiesBind(mVelocity, mValid);
   mAdvection.AdvectParticleBind(mParticles, mDynamicSolidPhi, mParticleCount.GetDispatchParams());
 }
 
-WaterWorld::~WaterWorld() {}
+WaterWorld::~WaterWorld()
+{
+  WaitCheckpoint();
+}
 
 void WaterWorld::Substep(LinearSolver::Parameters& params)
 {
@@ -276,8 +535,7 @@ void WaterWorld::Substep(LinearSolver::Parameters& params)
 
   // 2)
   mParticleCount.TransferToGrid();
-  mExtrapolation.Extrapolate();
-  mVelocity.SaveCopy();
+  mExtrapolation.ExtrapolateSaveCopy();
 
   // 3)
   for (auto& velocity : mVelocities)
@@ -314,7 +572,6 @@ void WaterWorld::Substep(LinearSolver::Parameters& params)
   ForAll(mRigidbodies, &RigidBody::VelocityConstrain);
 
   // 6)
-  mVelocity.VelocityDiff();
   mParticleCount.TransferFromGrid();
 
   // 7)
@@ -330,8 +587,51 @@ Renderer::RenderCommand WaterWorld::RecordParticleCount(
   return mParticleCount.Record(drawables);
 }
 
+void WaterWorld::CheckpointBind(FieldCacheWriter& writer)
+{
+  World::CheckpointBind(writer);
+  writer.AddParticles("particles", mParticles, mParticleCount);
+}
+
+void WaterWorld::CheckpointLoad(FieldCacheReader& reader)
+{
+  World::CheckpointLoad(reader);
+
+  auto particles = reader.ReadParticles(0, "particles");
+  ReserveParticles(static_cast<int>(particles.size()));
+  if (particles.size() * sizeof(Particle) > mParticles.Size())
+    throw std::runtime_error("Too many particles in checkpoint");
+
+  if (!particles.empty())
+  {
+    Renderer::GenericBuffer input(
+        mDevice, Renderer::BufferUsage::Storage, Renderer::MemoryUsage::Cpu, mParticles.Size());
+    input.CopyFrom(
+        0, particles.data(), static_cast<uint32_t>(particles.size() * sizeof(Particle)));
+    mDevice.Execute([&](Renderer::CommandEncoder& command)
+                    { mParticles.CopyFrom(command, input); });
+  }
+
+  mParticleCount.SetTotalCount(static_cast<int>(particles.size()));
+}
+
+void WaterWorld::ReserveParticles(int capacity)
+{
+  if (mParticleCount.Reserve(capacity))
+  {
+    mAdvection.AdvectParticleBind(mParticles, mDynamicSolidPhi, mParticleCount.GetDispatchParams());
+  }
+}
+
 void WaterWorld::ParticlePhi()
 {
+  // grow with some margin, particles that didn't fit are added in this scan
+  int required = mParticleCount.GetRequiredCapacity();
+  if (required > mParticleCount.GetCapacity())
+  {
+    ReserveParticles(required + required / 2);
+  }
+
   mParticleCount.Scan();
   mParticleCount.Phi();
   mLiquidPhi.Reinitialise();
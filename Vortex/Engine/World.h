@@ -14,6 +14,7 @@
 #include <Vortex/Engine/Cfl.h>
 #include <Vortex/Engine/Density.h>
 #include <Vortex/Engine/Extrapolation.h>
+#include <Vortex/Engine/FieldCache.h>
 #include <Vortex/Engine/LevelSet.h>
 #include <Vortex/Engine/LinearSolver/ConjugateGradient.h>
 #include <Vortex/Engine/LinearSolver/LinearSolver.h>
@@ -21,10 +22,12 @@
 #include <Vortex/Engine/Particles.h>
 #include <Vortex/Engine/Pressure.h>
 #include <Vortex/Engine/Rigidbody.h>
+#include <Vortex/Engine/TimeStep.h>
 #include <Vortex/Engine/Velocity.h>
 
 #include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace Vortex
@@ -55,12 +58,17 @@ public:
    * @param dt timestamp of the simulation, e.g. 0.016 for 60FPS simulations.
    * @param numSubSteps the number of sub-steps to perform per step call.
    * Reduces loss of fluid.
+   * @param interpolationMode interpolation of the velocity in the advections
+   * @param precision storage of the coarse levels of the multigrid
+   * preconditioner of the pressure solver. In half precision, the pressure is
+   * still solved in single precision, with iterative refinement steps.
    */
   World(Renderer::Device& device,
         const glm::ivec2& size,
         float dt,
         int numSubSteps = 1,
-        Velocity::InterpolationMode interpolationMode = Velocity::InterpolationMode::Linear);
+        Velocity::InterpolationMode interpolationMode = Velocity::InterpolationMode::Linear,
+        LinearSolver::Precision precision = LinearSolver::Precision::Single);
   virtual ~World() = default;
 
   /**
@@ -141,20 +149,107 @@ public:
    */
   VORTEX_API float GetCFL();
 
+  /**
+   * @brief The CFL number computed at the end of the last completed step.
+   * Non-blocking, see @ref Cfl::GetLast. It is only computed once enabled with
+   * @ref SetComputeLastCFL.
+   * @return CFL number, or 0 if it hasn't been computed yet
+   */
+  VORTEX_API float GetLastCFL();
+
+  /**
+   * @brief Compute the CFL number at the end of each step, to be read with
+   * @ref GetLastCFL. Disabled by default as it adds a reduction to every step.
+   * @param enable whether to compute it
+   */
+  VORTEX_API void SetComputeLastCFL(bool enable);
+
+  /**
+   * @brief Choose the number and size of the substeps on the device, from the
+   * CFL number of the velocity, instead of the fixed numSubSteps. Each step
+   * submits maxSubSteps substeps, the ones past the time of the step have a
+   * size of zero and don't advect, but still solve the pressure, so
+   * maxSubSteps bounds the cost of a step. Time is only dropped when
+   * maxSubSteps isn't enough, see @ref GetDroppedTime. Only the advection uses
+   * the size of each substep, the velocities submitted with
+   * @ref SubmitVelocity are applied once per step as before. Rigid bodies are
+   * coupled with the fixed substep size and cannot be used with adaptive
+   * substeps.
+   * @param targetCfl the CFL number each substep should respect
+   * @param maxSubSteps maximum number of substeps in a step
+   */
+  VORTEX_API void SetAdaptiveSubSteps(float targetCfl, int maxSubSteps);
+
+  /**
+   * @brief The number of substeps submitted by the last @ref Step, which is
+   * maxSubSteps with adaptive substeps, see @ref TimeStep::GetSubSteps for the
+   * number of substeps actually needed.
+   * @return number of substeps
+   */
+  VORTEX_API int GetLastSubSteps() const;
+
+  /**
+   * @brief With adaptive substeps, the time dropped by the last completed step
+   * because it didn't have enough substeps. Non-blocking, see
+   * @ref TimeStep::GetDroppedTime.
+   * @return the dropped time, 0 without adaptive substeps
+   */
+  VORTEX_API float GetDroppedTime();
+
+  /**
+   * @brief Choose the scheme to advect the velocity and the density fields,
+   * see @ref Advection::SetScheme. Particles are not affected.
+   * @param scheme the advection scheme
+   */
+  VORTEX_API void SetAdvectionScheme(Advection::Scheme scheme);
+
   /**
    * @brief Get the velocity, can be used to display it.
    * @return velocity field reference
    */
   VORTEX_API Renderer::Texture& GetVelocity();
 
+  /**
+   * @brief Save the state of the simulation in a file: velocity, level sets,
+   * pressure, rigid bodies and the fields specific to the world (densities or
+   * particles). The fields are copied asynchronously and written on a
+   * background thread. The file is completed with @ref WaitCheckpoint, on the
+   * next checkpoint or when the world is destroyed.
+   * @param filename the checkpoint file
+   */
+  VORTEX_API void SaveCheckpoint(const std::string& filename);
+
+  /**
+   * @brief Wait for the last checkpoint to be completely written.
+   */
+  VORTEX_API void WaitCheckpoint();
+
+  /**
+   * @brief Restore the state saved with @ref SaveCheckpoint. The same rigid
+   * bodies and density fields need to have been added, in the same order.
+   * @param filename the checkpoint file
+   */
+  VORTEX_API void LoadCheckpoint(const std::string& filename);
+
 protected:
+  struct RigidBodyState
+  {
+    alignas(8) glm::vec2 Position;
+    alignas(8) glm::vec2 Velocity;
+    alignas(4) float Rotation;
+    alignas(4) float AngularVelocity;
+  };
+
   void StepRigidBodies();
   virtual void Substep(LinearSolver::Parameters& params) = 0;
+  virtual void CheckpointBind(FieldCacheWriter& writer);
+  virtual void CheckpointLoad(FieldCacheReader& reader);
 
   Renderer::Device& mDevice;
   glm::ivec2 mSize;
   float mDelta;
   int mNumSubSteps;
+  int mLastSubSteps;
 
   glm::ivec2 mSolverSize;
   Multigrid mPreconditioner;
@@ -185,6 +280,11 @@ protected:
   std::vector<Renderer::RenderCommand*> mVelocities;
 
   Cfl mCfl;
+  bool mComputeLastCfl;
+  std::unique_ptr<TimeStep> mTimeStep;
+
+  std::unique_ptr<Renderer::Buffer<RigidBodyState>> mRigidbodyStates;
+  std::unique_ptr<FieldCacheWriter> mCheckpoint;
 };
 
 /**
@@ -194,20 +294,37 @@ protected:
 class SmokeWorld : public World
 {
 public:
+  /**
+   * @brief Initialize the smoke world, see @ref World.
+   */
   VORTEX_API SmokeWorld(Renderer::Device& device,
                         const glm::ivec2& size,
                         float dt,
-                        Velocity::InterpolationMode interpolationMode);
+                        Velocity::InterpolationMode interpolationMode,
+                        LinearSolver::Precision precision = LinearSolver::Precision::Single);
   VORTEX_API ~SmokeWorld() override;
 
   /**
-   * @brief Bind a density field to be moved around with the fluid
+   * @brief Bind a density field to be moved around with the fluid. Its size
+   * can be an integer multiple of the world size. Several density fields can
+   * be bound, binding one already bound does nothing. The density must stay
+   * alive until it is unbound with @ref FieldUnbind or the world is destroyed.
    * @param density the density field
    */
   VORTEX_API void FieldBind(Density& density);
 
+  /**
+   * @brief Unbind a density field, which isn't moved with the fluid anymore.
+   * @param density the density field
+   */
+  VORTEX_API void FieldUnbind(Density& density);
+
 private:
   void Substep(LinearSolver::Parameters& params) override;
+  void CheckpointBind(FieldCacheWriter& writer) override;
+  void CheckpointLoad(FieldCacheReader& reader) override;
+
+  std::vector<Density*> mDensities;
 };
 
 /**
@@ -216,11 +333,22 @@ private:
 class WaterWorld : public World
 {
 public:
+  /**
+   * @brief Initialize the water world. The particle buffers grow as needed,
+   * up to particlesPerCell particles for each grid cell.
+   * @param particlesPerCell maximum number of particles in a grid cell
+   * @param particleCapacity initial number of particles the buffers can hold,
+   * 0 for a quarter of the maximum.
+   * @param precision storage of the multigrid preconditioner, see @ref World
+   */
   VORTEX_API WaterWorld(Renderer::Device& device,
                         const glm::ivec2& size,
                         float dt,
                         int numSubSteps,
-                        Velocity::InterpolationMode interpolationMode);
+                        Velocity::InterpolationMode interpolationMode,
+                        int particlesPerCell = 8,
+                        int particleCapacity = 0,
+                        LinearSolver::Precision precision = LinearSolver::Precision::Single);
   VORTEX_API ~WaterWorld() override;
 
   /**
@@ -243,6 +371,9 @@ public:
 
 private:
   void Substep(LinearSolver::Parameters& params) override;
+  void CheckpointBind(FieldCacheWriter& writer) override;
+  void CheckpointLoad(FieldCacheReader& reader) override;
+  void ReserveParticles(int capacity);
 
   Renderer::GenericBuffer mParticles;
   ParticleCount mParticleCount;
@@ -14,6 +14,39 @@ namespace Renderer
 class Texture;
 class Device;
 class CommandEncoder;
+class GenericBuffer;
+
+/**
+ * @brief Device memory shared by several buffers which are never used at the
+ * same time, e.g. scratch buffers of different phases of a solver. The buffers
+ * are created with this memory, then @ref Allocate binds all of them to a
+ * single allocation big enough for the largest one. The content of a buffer is
+ * undefined after another buffer sharing the memory has been written.
+ */
+class TransientMemory
+{
+public:
+  VORTEX_API TransientMemory(Device& device);
+  VORTEX_API TransientMemory(TransientMemory&& other);
+  VORTEX_API ~TransientMemory();
+
+  /**
+   * @brief Allocate the memory and bind it to all the buffers created with
+   * it. Needs to be called before the buffers are used.
+   */
+  VORTEX_API void Allocate();
+
+  /**
+   * @brief The size in bytes of the allocation
+   */
+  VORTEX_API std::uint64_t Size() const;
+
+private:
+  friend class GenericBuffer;
+
+  struct Impl;
+  std::unique_ptr<Impl> mImpl;
+};
 
 /**
  * @brief A vulkan buffer which can be on the host or the device.
@@ -26,6 +59,19 @@ public:
                            MemoryUsage memoryUsage,
                            std::uint64_t deviceSize);
 
+  /**
+   * @brief Create a device buffer which uses the transient memory instead of
+   * its own allocation. It cannot be resized.
+   * @param device vulkan device
+   * @param usageFlags usage of the buffer
+   * @param deviceSize size in bytes
+   * @param memory the memory shared with other buffers
+   */
+  VORTEX_API GenericBuffer(Device& device,
+                           BufferUsage usageFlags,
+                           std::uint64_t deviceSize,
+                           TransientMemory& memory);
+
   VORTEX_API GenericBuffer(GenericBuffer&& other);
   VORTEX_API virtual ~GenericBuffer();
 
@@ -36,6 +82,15 @@ public:
    */
   VORTEX_API void CopyFrom(CommandEncoder& command, GenericBuffer& srcBuffer);
 
+  /**
+   * @brief Copy the beginning of a buffer to this buffer, the buffers can be
+   * of different sizes.
+   * @param commandBuffer command buffer to run the copy on.
+   * @param srcBuffer the source buffer.
+   * @param size the size in bytes to copy, at most the size of either buffer.
+   */
+  VORTEX_API void CopyFrom(CommandEncoder& command, GenericBuffer& srcBuffer, std::uint64_t size);
+
   /**
    * @brief Copy a texture to this buffer
    * @param commandBuffer command buffer to run the copy on.
@@ -131,6 +186,11 @@ public:
       : GenericBuffer(device, BufferUsage::Storage, memoryUsage, sizeof(T) * size)
   {
   }
+
+  Buffer(Device& device, std::size_t size, TransientMemory& memory)
+      : GenericBuffer(device, BufferUsage::Storage, sizeof(T) * size, memory)
+  {
+  }
 };
 
 /**
@@ -47,7 +47,7 @@ public:
                                 uint32_t size,
                                 const void* pValues);
 
-  VORTEX_API void Draw(std::uint32_t vertexCount);
+  VORTEX_API void Draw(std::uint32_t vertexCount, std::uint32_t instanceCount = 1);
   VORTEX_API void DrawIndexedIndirect(const GenericBuffer& buffer);
   VORTEX_API void Dispatch(std::uint32_t x, std::uint32_t y, std::uint32_t z);
   VORTEX_API void DispatchIndirect(GenericBuffer& buffer);
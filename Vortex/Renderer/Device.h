@@ -9,7 +9,9 @@
 #include <Vortex/Renderer/CommandBuffer.h>
 #include <Vortex/Renderer/Common.h>
 #include <Vortex/Renderer/Pipeline.h>
+#include <future>
 #include <map>
+#include <string>
 
 namespace Vortex
 {
@@ -32,6 +34,17 @@ public:
 
   VORTEX_API virtual bool HasTimer() const = 0;
 
+  /**
+   * @brief Check if textures of the format can be sampled with a linear
+   * filter, with at least 8 bits of sub-texel precision for the weights
+   */
+  VORTEX_API virtual bool HasLinearFilter(Format format) const = 0;
+
+  /**
+   * @brief Name identifying the device and its driver version
+   */
+  VORTEX_API virtual std::string GetName() const = 0;
+
   VORTEX_API virtual void Execute(CommandBuffer::CommandFn commandFn) const = 0;
   VORTEX_API virtual Handle::ShaderModule CreateShaderModule(const SpirvBinary& spirv) = 0;
 
@@ -75,6 +88,19 @@ public:
   VORTEX_API virtual Handle::Pipeline CreateComputePipeline(Handle::ShaderModule shader,
                                                             Handle::PipelineLayout layout,
                                                             SpecConstInfo specConstInfo = {}) = 0;
+
+  /**
+   * @brief Create a compute pipeline on a background thread. Pipelines
+   * requested this way are compiled in parallel, the future is ready once
+   * the pipeline is compiled.
+   * @param shader
+   * @param layout
+   * @param specConstInfo
+   */
+  VORTEX_API virtual std::shared_future<Handle::Pipeline> CreateComputePipelineAsync(
+      Handle::ShaderModule shader,
+      Handle::PipelineLayout layout,
+      SpecConstInfo specConstInfo = {}) = 0;
 };
 
 }  // namespace Renderer
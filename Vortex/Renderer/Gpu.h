@@ -29,6 +29,9 @@ enum class Format
   B8G8R8A8Unorm,
   R32G32Sfloat,
   R32G32B32A32Sfloat,
+  R16Sfloat,
+  R16G16Sfloat,
+  R16G16B16A16Sfloat,
 };
 
 enum class ShaderStage
@@ -58,6 +61,7 @@ enum class Access
   None,
   Write,
   Read,
+  HostRead,
 };
 
 enum class ImageLayout
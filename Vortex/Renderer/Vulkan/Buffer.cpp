@@ -11,6 +11,8 @@
 
 #include "Device.h"
 
+#include <algorithm>
+
 namespace Vortex
 {
 namespace Renderer
@@ -36,14 +38,99 @@ void BufferBarrier(Handle::Buffer buffer,
                                   .setDstAccessMask(newAccess);
 
   vk::CommandBuffer cmd = reinterpret_cast<VkCommandBuffer>(command);
-  cmd.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands,
-                      vk::PipelineStageFlagBits::eAllCommands,
+  cmd.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands | vk::PipelineStageFlagBits::eHost,
+                      vk::PipelineStageFlagBits::eAllCommands | vk::PipelineStageFlagBits::eHost,
                       {},
                       nullptr,
                       bufferMemoryBarriers,
                       nullptr);
 }
 
+struct TransientMemory::Impl
+{
+  VulkanDevice& mDevice;
+  std::vector<VkBuffer> mBuffers;
+  VkMemoryRequirements mRequirements;
+  VmaAllocation mAllocation;
+
+  Impl(Device& device) : mDevice(static_cast<VulkanDevice&>(device)), mAllocation(VK_NULL_HANDLE)
+  {
+    mRequirements.size = 0;
+    mRequirements.alignment = 1;
+    mRequirements.memoryTypeBits = ~0u;
+  }
+
+  ~Impl()
+  {
+    if (mAllocation != VK_NULL_HANDLE)
+    {
+      vmaFreeMemory(mDevice.Allocator(), mAllocation);
+    }
+  }
+
+  void Add(VkBuffer buffer)
+  {
+    if (mAllocation != VK_NULL_HANDLE)
+    {
+      throw std::runtime_error("Transient memory already allocated");
+    }
+
+    auto requirements = mDevice.Handle().getBufferMemoryRequirements(vk::Buffer(buffer));
+
+    mRequirements.size = std::max(mRequirements.size, requirements.size);
+    mRequirements.alignment = std::max(mRequirements.alignment, requirements.alignment);
+    mRequirements.memoryTypeBits &= requirements.memoryTypeBits;
+    if (mRequirements.memoryTypeBits == 0)
+    {
+      throw std::runtime_error("Incompatible buffers in transient memory");
+    }
+
+    mBuffers.push_back(buffer);
+  }
+
+  void Allocate()
+  {
+    if (mAllocation != VK_NULL_HANDLE || mBuffers.empty())
+    {
+      return;
+    }
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = ConvertMemoryUsage(MemoryUsage::Gpu);
+    if (vmaAllocateMemory(
+            mDevice.Allocator(), &mRequirements, &allocInfo, &mAllocation, nullptr) != VK_SUCCESS)
+    {
+      throw std::runtime_error("Error allocating transient memory");
+    }
+
+    for (auto buffer : mBuffers)
+    {
+      if (vmaBindBufferMemory(mDevice.Allocator(), mAllocation, buffer) != VK_SUCCESS)
+      {
+        throw std::runtime_error("Error binding transient memory");
+      }
+    }
+  }
+
+  std::uint64_t Size() const { return mAllocation != VK_NULL_HANDLE ? mRequirements.size : 0; }
+};
+
+TransientMemory::TransientMemory(Device& device) : mImpl(std::make_unique<Impl>(device)) {}
+
+TransientMemory::TransientMemory(TransientMemory&& other) : mImpl(std::move(other.mImpl)) {}
+
+TransientMemory::~TransientMemory() {}
+
+void TransientMemory::Allocate()
+{
+  mImpl->Allocate();
+}
+
+std::uint64_t TransientMemory::Size() const
+{
+  return mImpl->Size();
+}
+
 struct GenericBuffer::Impl
 {
   VulkanDevice& mDevice;
@@ -53,21 +140,47 @@ struct GenericBuffer::Impl
   VkBuffer mBuffer;
   VmaAllocation mAllocation;
   VmaAllocationInfo mAllocationInfo;
+  bool mTransient;
 
   Impl(Device& device, BufferUsage usageFlags, MemoryUsage memoryUsage, std::uint64_t deviceSize)
       : mDevice(static_cast<VulkanDevice&>(device))
       , mSize(deviceSize)
       , mUsageFlags(ConvertBufferUsage(usageFlags))
       , mMemoryUsage(memoryUsage)
+      , mTransient(false)
   {
     Create();
   }
 
+  Impl(Device& device, BufferUsage usageFlags, std::uint64_t deviceSize)
+      : mDevice(static_cast<VulkanDevice&>(device))
+      , mSize(deviceSize)
+      , mUsageFlags(ConvertBufferUsage(usageFlags))
+      , mMemoryUsage(MemoryUsage::Gpu)
+      , mAllocation(VK_NULL_HANDLE)
+      , mAllocationInfo{}
+      , mTransient(true)
+  {
+    auto bufferInfo = vk::BufferCreateInfo()
+                          .setSize(mSize)
+                          .setUsage(mUsageFlags)
+                          .setSharingMode(vk::SharingMode::eExclusive);
+
+    mBuffer = static_cast<VkBuffer>(mDevice.Handle().createBuffer(bufferInfo));
+  }
+
   ~Impl()
   {
     if (mBuffer != VK_NULL_HANDLE)
     {
-      vmaDestroyBuffer(mDevice.Allocator(), mBuffer, mAllocation);
+      if (mTransient)
+      {
+        mDevice.Handle().destroyBuffer(vk::Buffer(mBuffer));
+      }
+      else
+      {
+        vmaDestroyBuffer(mDevice.Allocator(), mBuffer, mAllocation);
+      }
     }
   }
 
@@ -79,6 +192,7 @@ struct GenericBuffer::Impl
       , mBuffer(other.mBuffer)
       , mAllocation(other.mAllocation)
       , mAllocationInfo(other.mAllocationInfo)
+      , mTransient(other.mTransient)
   {
     other.mBuffer = VK_NULL_HANDLE;
     other.mAllocation = VK_NULL_HANDLE;
@@ -95,6 +209,12 @@ struct GenericBuffer::Impl
     VkBufferCreateInfo vkBufferInfo = static_cast<VkBufferCreateInfo>(bufferInfo);
     VmaAllocationCreateInfo allocInfo = {};
     allocInfo.usage = ConvertMemoryUsage(mMemoryUsage);
+    if (mMemoryUsage != MemoryUsage::Gpu)
+    {
+      // host buffers stay mapped, so they can be read or written at any time
+      allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    }
+
     if (vmaCreateBuffer(mDevice.Allocator(),
                         &vkBufferInfo,
                         &allocInfo,
@@ -115,6 +235,11 @@ struct GenericBuffer::Impl
 
   void Resize(std::uint64_t size)
   {
+    if (mTransient)
+    {
+      throw std::runtime_error("Cannot resize buffer using transient memory");
+    }
+
     if (mBuffer != VK_NULL_HANDLE)
     {
       vmaDestroyBuffer(mDevice.Allocator(), mBuffer, mAllocation);
@@ -131,6 +256,16 @@ struct GenericBuffer::Impl
       throw std::runtime_error("Cannot copy buffers of different sizes");
     }
 
+    CopyFrom(command, srcBuffer, mSize);
+  }
+
+  void CopyFrom(CommandEncoder& command, GenericBuffer& srcBuffer, std::uint64_t size)
+  {
+    if (size > mSize || size > srcBuffer.Size())
+    {
+      throw std::runtime_error("Cannot copy more than the buffer size");
+    }
+
     // TODO improve barriers
     BufferBarrier(srcBuffer.Handle(),
                   command.Handle(),
@@ -141,7 +276,7 @@ struct GenericBuffer::Impl
                   vk::AccessFlagBits::eShaderRead,
                   vk::AccessFlagBits::eTransferWrite);
 
-    auto region = vk::BufferCopy().setSize(mSize);
+    auto region = vk::BufferCopy().setSize(size);
 
     vk::CommandBuffer cmd = Handle::ConvertCommandBuffer(command.Handle());
     cmd.copyBuffer(Handle::ConvertBuffer(srcBuffer.Handle()), mBuffer, region);
@@ -216,52 +351,68 @@ struct GenericBuffer::Impl
                   vk::AccessFlagBits::eShaderRead);
   }
 
-  void CopyFrom(uint32_t offset, const void* data, uint32_t size)
+  VkMemoryPropertyFlags HostMemoryFlags()
   {
-    // TODO use always mapped functionality of VMA
+    if (mTransient)
+      throw std::runtime_error("Not visible buffer");
 
     VkMemoryPropertyFlags memFlags;
     vmaGetMemoryTypeProperties(mDevice.Allocator(), mAllocationInfo.memoryType, &memFlags);
     if ((memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == 0)
       throw std::runtime_error("Not visible buffer");
 
+    return memFlags;
+  }
+
+  void* Map()
+  {
+    if (mAllocationInfo.pMappedData != nullptr)
+      return mAllocationInfo.pMappedData;
+
+    // device buffers which happen to be host visible are mapped on demand
     void* pData;
     if (vmaMapMemory(mDevice.Allocator(), mAllocation, &pData) != VK_SUCCESS)
       throw std::runtime_error("Cannot map buffer");
 
+    return pData;
+  }
+
+  void Unmap()
+  {
+    if (mAllocationInfo.pMappedData == nullptr)
+    {
+      vmaUnmapMemory(mDevice.Allocator(), mAllocation);
+    }
+  }
+
+  void CopyFrom(uint32_t offset, const void* data, uint32_t size)
+  {
+    auto memFlags = HostMemoryFlags();
+    void* pData = Map();
+
     std::memcpy((uint8_t*)pData + offset, data, size);
 
     if ((memFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0)
     {
-      vmaFlushAllocation(
-          mDevice.Allocator(), mAllocation, mAllocationInfo.offset, mAllocationInfo.size);
+      vmaFlushAllocation(mDevice.Allocator(), mAllocation, offset, size);
     }
 
-    vmaUnmapMemory(mDevice.Allocator(), mAllocation);
+    Unmap();
   }
 
   void CopyTo(uint32_t offset, void* data, uint32_t size)
   {
-    // TODO use always mapped functionality of VMA
-
-    VkMemoryPropertyFlags memFlags;
-    vmaGetMemoryTypeProperties(mDevice.Allocator(), mAllocationInfo.memoryType, &memFlags);
-    if ((memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == 0)
-      throw std::runtime_error("Not visible buffer");
-
-    void* pData;
-    if (vmaMapMemory(mDevice.Allocator(), mAllocation, &pData) != VK_SUCCESS)
-      throw std::runtime_error("Cannot map buffer");
+    auto memFlags = HostMemoryFlags();
+    void* pData = Map();
 
     if ((memFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0)
     {
-      vmaInvalidateAllocation(
-          mDevice.Allocator(), mAllocation, mAllocationInfo.offset, mAllocationInfo.size);
+      vmaInvalidateAllocation(mDevice.Allocator(), mAllocation, offset, size);
     }
 
     std::memcpy(data, (uint8_t*)pData + offset, size);
 
-    vmaUnmapMemory(mDevice.Allocator(), mAllocation);
+    Unmap();
   }
 };
 
@@ -273,6 +424,15 @@ GenericBuffer::GenericBuffer(Device& device,
 {
 }
 
+GenericBuffer::GenericBuffer(Device& device,
+                             BufferUsage usageFlags,
+                             std::uint64_t deviceSize,
+                             TransientMemory& memory)
+    : mImpl(std::make_unique<GenericBuffer::Impl>(device, usageFlags, deviceSize))
+{
+  memory.mImpl->Add(mImpl->mBuffer);
+}
+
 GenericBuffer::GenericBuffer(GenericBuffer&& other) : mImpl(std::move(other.mImpl)) {}
 
 GenericBuffer::~GenericBuffer() {}
@@ -282,6 +442,11 @@ void GenericBuffer::CopyFrom(CommandEncoder& command, GenericBuffer& srcBuffer)
   mImpl->CopyFrom(command, srcBuffer);
 }
 
+void GenericBuffer::CopyFrom(CommandEncoder& command, GenericBuffer& srcBuffer, std::uint64_t size)
+{
+  mImpl->CopyFrom(command, srcBuffer, size);
+}
+
 void GenericBuffer::CopyFrom(CommandEncoder& command, Texture& srcTexture)
 {
   mImpl->CopyFrom(command, srcTexture);
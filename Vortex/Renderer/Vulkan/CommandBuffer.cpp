@@ -84,7 +84,10 @@ struct CommandEncoder::Impl
     mCommandBuffer->pushConstants(layout, ConvertShaderStage(stageFlags), offset, size, pValues);
   }
 
-  void Draw(std::uint32_t vertexCount) { mCommandBuffer->draw(vertexCount, 1, 0, 0); }
+  void Draw(std::uint32_t vertexCount, std::uint32_t instanceCount)
+  {
+    mCommandBuffer->draw(vertexCount, instanceCount, 0, 0);
+  }
 
   void DrawIndexedIndirect(const GenericBuffer& buffer)
   {
@@ -188,9 +191,9 @@ void CommandEncoder::PushConstants(Handle::PipelineLayout layout,
       reinterpret_cast<VkPipelineLayout>(layout), stageFlags, offset, size, pValues);
 }
 
-void CommandEncoder::Draw(std::uint32_t vertexCount)
+void CommandEncoder::Draw(std::uint32_t vertexCount, std::uint32_t instanceCount)
 {
-  mImpl->Draw(vertexCount);
+  mImpl->Draw(vertexCount, instanceCount);
 }
 
 void CommandEncoder::DrawIndexedIndirect(const GenericBuffer& buffer)
@@ -256,19 +256,76 @@ VulkanDevice::VulkanDevice(const Instance& instance, int familyIndex, bool surfa
   CreateDescriptorPool();
   mPipelineCache = mDevice->createPipelineCacheUnique({});
   mCommandBuffer = std::make_unique<CommandBuffer>(*this, true);
+
+  // threads compiling the pipelines
+  unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned i = 0; i < numThreads; i++)
+  {
+    mCompileThreads.emplace_back(&VulkanDevice::CompilePipelines, this);
+  }
 }
 
 VulkanDevice::~VulkanDevice()
 {
+  {
+    std::lock_guard<std::mutex> lock(mCompileMutex);
+    mCompileQuit = true;
+  }
+  mCompileCondition.notify_all();
+  for (auto& thread : mCompileThreads)
+  {
+    thread.join();
+  }
+
   vmaDestroyAllocator(mAllocator);
 }
 
+void VulkanDevice::CompilePipelines()
+{
+  while (true)
+  {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mCompileMutex);
+      mCompileCondition.wait(lock, [&] { return mCompileQuit || !mCompileTasks.empty(); });
+      if (mCompileTasks.empty())
+        return;
+
+      task = std::move(mCompileTasks.front());
+      mCompileTasks.pop_front();
+    }
+
+    task();
+  }
+}
+
 bool VulkanDevice::HasTimer() const
 {
   auto properties = mPhysicalDevice.getProperties();
   return properties.limits.timestampComputeAndGraphics;
 }
 
+bool VulkanDevice::HasLinearFilter(Format format) const
+{
+  // the filter weights are quantised to the sub-texel precision, which can be
+  // as low as 4 bits
+  const uint32_t minSubTexelPrecisionBits = 8;
+  if (mPhysicalDevice.getProperties().limits.subTexelPrecisionBits < minSubTexelPrecisionBits)
+  {
+    return false;
+  }
+
+  auto properties = mPhysicalDevice.getFormatProperties(ConvertFormat(format));
+  return static_cast<bool>(properties.optimalTilingFeatures &
+                           vk::FormatFeatureFlagBits::eSampledImageFilterLinear);
+}
+
+std::string VulkanDevice::GetName() const
+{
+  auto properties = mPhysicalDevice.getProperties();
+  return std::string(properties.deviceName) + " " + std::to_string(properties.driverVersion);
+}
+
 void VulkanDevice::WaitIdle()
 {
   mDevice->waitIdle();
@@ -556,10 +613,20 @@ Handle::Pipeline VulkanDevice::CreateGraphicsPipeline(const GraphicsPipelineDesc
 Handle::Pipeline VulkanDevice::CreateComputePipeline(Handle::ShaderModule shader,
                                                      Handle::PipelineLayout layout,
                                                      SpecConstInfo specConstInfo)
+{
+  return CreateComputePipelineAsync(shader, layout, specConstInfo).get();
+}
+
+std::shared_future<Handle::Pipeline> VulkanDevice::CreateComputePipelineAsync(
+    Handle::ShaderModule shader,
+    Handle::PipelineLayout layout,
+    SpecConstInfo specConstInfo)
 {
   vk::ShaderModule shaderModule = reinterpret_cast<VkShaderModule>(shader);
   vk::PipelineLayout pipelineLayout = reinterpret_cast<VkPipelineLayout>(layout);
 
+  std::lock_guard<std::mutex> lock(mComputePipelinesMutex);
+
   auto it = std::find_if(mComputePipelines.begin(),
                          mComputePipelines.end(),
                          [&](const ComputePipelineCache& pipeline)
@@ -571,37 +638,49 @@ Handle::Pipeline VulkanDevice::CreateComputePipeline(Handle::ShaderModule shader
 
   if (it != mComputePipelines.end())
   {
-    VkPipeline handle = *it->Pipeline;
-    return reinterpret_cast<Handle::Pipeline>(handle);
+    return it->Future;
   }
 
   static_assert(sizeof(vk::SpecializationMapEntry) == sizeof(SpecConstInfo::Entry),
                 "Incorrect sized spec const info");
 
-  auto specInfo = vk::SpecializationInfo()
-                      .setMapEntryCount(static_cast<uint32_t>(specConstInfo.mapEntries.size()))
-                      .setPMapEntries(reinterpret_cast<vk::SpecializationMapEntry*>(
-                          specConstInfo.mapEntries.data()))
-                      .setDataSize(specConstInfo.data.size())
-                      .setPData(specConstInfo.data.data());
-
-  auto stageInfo = vk::PipelineShaderStageCreateInfo()
-                       .setModule(shaderModule)
-                       .setPName("main")
-                       .setStage(vk::ShaderStageFlagBits::eCompute)
-                       .setPSpecializationInfo(&specInfo);
-
-  auto pipelineInfo = vk::ComputePipelineCreateInfo().setStage(stageInfo).setLayout(
-      reinterpret_cast<VkPipelineLayout>(layout));
-
-  mComputePipelines.push_back(
-      {shaderModule,
-       pipelineLayout,
-       specConstInfo,
-       mDevice->createComputePipelineUnique(*mPipelineCache, pipelineInfo)});
-
-  VkPipeline handle = *mComputePipelines.back().Pipeline;
-  return reinterpret_cast<Handle::Pipeline>(handle);
+  auto pipeline = std::make_shared<vk::UniquePipeline>();
+  auto task = std::make_shared<std::packaged_task<Handle::Pipeline()>>(
+      [this, shaderModule, pipelineLayout, specConstInfo, pipeline]() mutable
+      {
+        auto specInfo =
+            vk::SpecializationInfo()
+                .setMapEntryCount(static_cast<uint32_t>(specConstInfo.mapEntries.size()))
+                .setPMapEntries(
+                    reinterpret_cast<vk::SpecializationMapEntry*>(specConstInfo.mapEntries.data()))
+                .setDataSize(specConstInfo.data.size())
+                .setPData(specConstInfo.data.data());
+
+        auto stageInfo = vk::PipelineShaderStageCreateInfo()
+                             .setModule(shaderModule)
+                             .setPName("main")
+                             .setStage(vk::ShaderStageFlagBits::eCompute)
+                             .setPSpecializationInfo(&specInfo);
+
+        auto pipelineInfo =
+            vk::ComputePipelineCreateInfo().setStage(stageInfo).setLayout(pipelineLayout);
+
+        *pipeline = mDevice->createComputePipelineUnique(*mPipelineCache, pipelineInfo);
+
+        VkPipeline handle = **pipeline;
+        return reinterpret_cast<Handle::Pipeline>(handle);
+      });
+
+  std::shared_future<Handle::Pipeline> future = task->get_future().share();
+  mComputePipelines.push_back({shaderModule, pipelineLayout, specConstInfo, pipeline, future});
+
+  {
+    std::lock_guard<std::mutex> compileLock(mCompileMutex);
+    mCompileTasks.emplace_back([task] { (*task)(); });
+  }
+  mCompileCondition.notify_one();
+
+  return future;
 }
 
 vk::UniqueCommandBuffer VulkanDevice::CreateCommandBuffer() const
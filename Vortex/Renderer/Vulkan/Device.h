@@ -10,7 +10,12 @@
 #include <Vortex/Renderer/Common.h>
 #include <Vortex/Renderer/Device.h>
 #include <Vortex/Renderer/Pipeline.h>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <map>
+#include <mutex>
+#include <thread>
 
 #include "Instance.h"
 
@@ -43,6 +48,10 @@ public:
   // Implementation of Device interface
   bool HasTimer() const override;
 
+  bool HasLinearFilter(Format format) const override;
+
+  std::string GetName() const override;
+
   void WaitIdle() override;
 
   void Execute(CommandBuffer::CommandFn commandFn) const override;
@@ -64,6 +73,11 @@ public:
                                          Handle::PipelineLayout layout,
                                          SpecConstInfo specConstInfo = {}) override;
 
+  std::shared_future<Handle::Pipeline> CreateComputePipelineAsync(
+      Handle::ShaderModule shader,
+      Handle::PipelineLayout layout,
+      SpecConstInfo specConstInfo = {}) override;
+
   // Vulkan specific functions
   VmaAllocator Allocator() const;
 
@@ -83,6 +97,7 @@ public:
 
 private:
   void CreateDescriptorPool(int size = 512);
+  void CompilePipelines();
 
   vk::PhysicalDevice mPhysicalDevice;
   DynamicDispatcher mLoader;
@@ -111,12 +126,20 @@ private:
     vk::ShaderModule Shader;
     vk::PipelineLayout Layout;
     SpecConstInfo SpecConst;
-    vk::UniquePipeline Pipeline;
+    std::shared_ptr<vk::UniquePipeline> Pipeline;
+    std::shared_future<Handle::Pipeline> Future;
   };
 
   std::vector<GraphicsPipelineCache> mGraphicsPipelines;
   std::vector<ComputePipelineCache> mComputePipelines;
+  std::mutex mComputePipelinesMutex;
   vk::UniquePipelineCache mPipelineCache;
+
+  std::vector<std::thread> mCompileThreads;
+  std::deque<std::function<void()>> mCompileTasks;
+  std::mutex mCompileMutex;
+  std::condition_variable mCompileCondition;
+  bool mCompileQuit = false;
 };
 
 }  // namespace Renderer
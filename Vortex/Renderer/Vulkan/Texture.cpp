@@ -46,12 +46,16 @@ std::uint64_t GetBytesPerPixel(Format format)
     case Format::R8Uint:
     case Format::R8Sint:
       return 1;
+    case Format::R16Sfloat:
+      return 2;
     case Format::R32Sfloat:
     case Format::R32Sint:
     case Format::R8G8B8A8Unorm:
     case Format::B8G8R8A8Unorm:
+    case Format::R16G16Sfloat:
       return 4;
     case Format::R32G32Sfloat:
+    case Format::R16G16B16A16Sfloat:
       return 8;
     case Format::R32G32B32A32Sfloat:
       return 16;
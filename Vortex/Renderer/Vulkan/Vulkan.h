@@ -73,6 +73,12 @@ inline vk::Format ConvertFormat(Format format)
       return vk::Format::eR32G32Sfloat;
     case Format::R32G32B32A32Sfloat:
       return vk::Format::eR32G32B32A32Sfloat;
+    case Format::R16Sfloat:
+      return vk::Format::eR16Sfloat;
+    case Format::R16G16Sfloat:
+      return vk::Format::eR16G16Sfloat;
+    case Format::R16G16B16A16Sfloat:
+      return vk::Format::eR16G16B16A16Sfloat;
   }
 }
 
@@ -147,6 +153,8 @@ inline vk::AccessFlags ConvertAccess(Access access)
       return vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eColorAttachmentRead;
     case Access::Write:
       return vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eColorAttachmentWrite;
+    case Access::HostRead:
+      return vk::AccessFlagBits::eHostRead;
   }
 }
 
@@ -12,14 +12,30 @@ namespace Vortex
 {
 namespace Renderer
 {
+namespace
+{
+glm::ivec2 localSize2D = {64, 4};
+int localSize1D = 256;
+}  // namespace
+
 glm::ivec2 ComputeSize::GetLocalSize2D()
 {
-  return {64, 4};
+  return localSize2D;
 }
 
 int ComputeSize::GetLocalSize1D()
 {
-  return 256;
+  return localSize1D;
+}
+
+void ComputeSize::SetLocalSize2D(const glm::ivec2& localSize)
+{
+  localSize2D = localSize;
+}
+
+void ComputeSize::SetLocalSize1D(int localSize)
+{
+  localSize1D = localSize;
 }
 
 glm::ivec2 ComputeSize::GetWorkSize(const glm::ivec2& size, const glm::ivec2& localSize)
@@ -112,13 +128,13 @@ Work::Work(Device& device,
                             SpecConstValue(1, mComputeSize.LocalSize.x),
                             SpecConstValue(2, mComputeSize.LocalSize.y));
 
-    mPipeline = mDevice.CreateComputePipeline(shaderModule, layout, specConstInfo);
+    mPipeline = mDevice.CreateComputePipelineAsync(shaderModule, layout, specConstInfo);
   }
   else
   {
     Detail::InsertSpecConst(specConstInfo, SpecConstValue(1, mComputeSize.LocalSize.x));
 
-    mPipeline = mDevice.CreateComputePipeline(shaderModule, layout, specConstInfo);
+    mPipeline = mDevice.CreateComputePipelineAsync(shaderModule, layout, specConstInfo);
   }
 }
 
@@ -145,14 +161,12 @@ Work::Bound Work::Bind(const std::vector<BindingInput>& inputs)
   return Bind(mComputeSize, inputs);
 }
 
-Work::Bound::Bound() : mComputeSize(ComputeSize::Default2D()), mLayout(nullptr), mPipeline(nullptr)
-{
-}
+Work::Bound::Bound() : mComputeSize(ComputeSize::Default2D()), mLayout(nullptr) {}
 
 Work::Bound::Bound(const ComputeSize& computeSize,
                    uint32_t pushConstantSize,
                    Handle::PipelineLayout layout,
-                   Handle::Pipeline pipeline,
+                   std::shared_future<Handle::Pipeline> pipeline,
                    BindGroup bindGroup)
     : mComputeSize(computeSize)
     , mPushConstantSize(pushConstantSize)
@@ -171,7 +185,7 @@ void Work::Bound::Record(CommandEncoder& command)
   }
 
   command.SetBindGroup(PipelineBindPoint::Compute, mLayout, mBindGroup);
-  command.SetPipeline(PipelineBindPoint::Compute, mPipeline);
+  command.SetPipeline(PipelineBindPoint::Compute, mPipeline.get());
 
   command.Dispatch(mComputeSize.WorkSize.x, mComputeSize.WorkSize.y, 1);
 }
@@ -186,7 +200,7 @@ void Work::Bound::RecordIndirect(CommandEncoder& command,
   }
 
   command.SetBindGroup(PipelineBindPoint::Compute, mLayout, mBindGroup);
-  command.SetPipeline(PipelineBindPoint::Compute, mPipeline);
+  command.SetPipeline(PipelineBindPoint::Compute, mPipeline.get());
   command.DispatchIndirect(dispatchParams);
 }
 
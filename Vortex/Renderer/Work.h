@@ -34,6 +34,21 @@ struct ComputeSize
    */
   VORTEX_API static int GetLocalSize1D();
 
+  /**
+   * @brief Set the default local size for 2D compute shaders. Only affects
+   * objects created afterwards, so should be set before creating any.
+   * The x component needs to be a multiple of 2.
+   * @param localSize the local size
+   */
+  VORTEX_API static void SetLocalSize2D(const glm::ivec2& localSize);
+
+  /**
+   * @brief Set the default local size for 1D compute shaders. Only affects
+   * objects created afterwards, so should be set before creating any.
+   * @param localSize the local size
+   */
+  VORTEX_API static void SetLocalSize1D(int localSize);
+
   /**
    * @brief Computes the 2D group size given a domain size
    * @param size the domain size of the shader
@@ -121,7 +136,8 @@ class Work
 public:
   /**
    * @brief Constructs an object using a SPIRV binary. It is not bound to any
-   * buffers or textures.
+   * buffers or textures. The pipeline is compiled in the background, in
+   * parallel with the other works, and is only waited on when recording.
    * @param device vulkan device
    * @param computeSize the compute size. Can be a default one with size (1,1)
    * or one with an actual size.
@@ -177,7 +193,7 @@ public:
     Bound(const ComputeSize& computeSize,
           uint32_t pushConstantSize,
           Handle::PipelineLayout layout,
-          Handle::Pipeline pipeline,
+          std::shared_future<Handle::Pipeline> pipeline,
           BindGroup bindGroup);
 
     template <typename Arg>
@@ -202,7 +218,7 @@ public:
     ComputeSize mComputeSize;
     uint32_t mPushConstantSize;
     Handle::PipelineLayout mLayout;
-    Handle::Pipeline mPipeline;
+    std::shared_future<Handle::Pipeline> mPipeline;
     BindGroup mBindGroup;
   };
 
@@ -226,7 +242,7 @@ private:
   ComputeSize mComputeSize;
   Device& mDevice;
   SPIRV::ShaderLayouts mLayout;
-  Handle::Pipeline mPipeline;
+  std::shared_future<Handle::Pipeline> mPipeline;
 };
 
 }  // namespace Renderer
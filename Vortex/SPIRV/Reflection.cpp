@@ -6,6 +6,8 @@
 #include "Reflection.h"
 #include <spirv_cross.hpp>
 
+#include <mutex>
+
 namespace Vortex
 {
 namespace SPIRV
@@ -24,6 +26,27 @@ unsigned ReadBinding(spirv_cross::Compiler& compiler,
 }
 
 Reflection::Reflection(const Renderer::SpirvBinary& spirv) : mPushConstantSize(0)
+{
+  // Parsing with spirv-cross is expensive and the same binaries are reflected
+  // many times, so the results are cached, keyed on the binary like the
+  // device's shader module cache.
+  static std::mutex cacheMutex;
+  static std::map<std::pair<const uint32_t*, std::size_t>, Reflection> cache;
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  auto key = std::make_pair(spirv.data(), spirv.size());
+  auto it = cache.find(key);
+  if (it != cache.end())
+  {
+    *this = it->second;
+    return;
+  }
+
+  Parse(spirv);
+  cache.emplace(key, *this);
+}
+
+void Reflection::Parse(const Renderer::SpirvBinary& spirv)
 {
   spirv_cross::Compiler compiler(spirv.data(), spirv.words());
   const auto& resources = compiler.get_shader_resources();
@@ -26,6 +26,8 @@ public:
   VORTEX_API Renderer::ShaderStage GetShaderStage() const;
 
 private:
+  void Parse(const Renderer::SpirvBinary& spirv);
+
   DescriptorTypesMap mDescriptorTypes;
   unsigned mPushConstantSize;
   Renderer::ShaderStage mStageFlag;
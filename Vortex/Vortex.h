@@ -11,6 +11,7 @@
 #include <Vortex/Renderer/Shapes.h>
 
 #include <Vortex/Engine/Density.h>
+#include <Vortex/Engine/LocalSizeTuner.h>
 #include <Vortex/Engine/World.h>
 
 #include <Vortex/SPIRV/Reflection.h>